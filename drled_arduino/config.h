@@ -11,6 +11,10 @@
 
 namespace DevRelief {
 
+// gamma from /api/config is clamped to this range
+#define MIN_GAMMA 0.1
+#define MAX_GAMMA 5.0
+
     class LedPin {
         public:
         LedPin(int n, int c, bool r) {
@@ -20,6 +24,7 @@ namespace DevRelief {
             pixelType = NEO_GRB;
             maxBrightness=50;
             pixelsPerMeter = 30;
+            gamma = 1;
         }
 
         ~LedPin() {
@@ -35,6 +40,8 @@ namespace DevRelief {
         uint16_t pixelType;
         uint8_t maxBrightness;
         uint16_t pixelsPerMeter;
+        // output level is (color/255)^gamma.  1 is linear
+        float gamma;
     };
 
     class ScriptDetails {
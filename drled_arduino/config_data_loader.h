@@ -194,6 +194,7 @@ class ConfigDataLoader : public DataLoader {
                                 configPin->maxBrightness = pin->getInt("maxBrightness",40);
                                 configPin->pixelType = getPixelType(pin->getString("pixelType","NEO_GRP"));
                                 configPin->pixelsPerMeter = pin->getInt("pixelsPerMeter",30);
+                                configPin->gamma = getGamma(pin->getFloat("gamma",1));
                             }
                         } else {
                             m_logger->error("pin is not an Object");
@@ -236,6 +237,7 @@ class ConfigDataLoader : public DataLoader {
                 pinElement->setInt("maxBrightness",pin->maxBrightness);
                 pinElement->setString("pixelType",getPixelType(pin->pixelType));
                 pinElement->setInt("pixelsPerMeter",pin->pixelsPerMeter);
+                pinElement->setFloat("gamma",pin->gamma);
                 pins->addItem(pinElement);
             });
             m_logger->debug(LM("pins done"));
@@ -276,6 +278,16 @@ class ConfigDataLoader : public DataLoader {
             return "NEO_GRB";
         }
 
+        // a gamma that is not > 0 (or NaN) would light black pixels, so it is linear
+        float getGamma(float gamma) {
+            if (!(gamma > 0)) {
+                m_logger->error("gamma %f must be > 0.  using 1",gamma);
+                return 1;
+            }
+            if (gamma < MIN_GAMMA) { return MIN_GAMMA;}
+            if (gamma > MAX_GAMMA) { return MAX_GAMMA;}
+            return gamma;
+        }
 
 
     protected:
@@ -260,6 +260,18 @@ namespace DevRelief {
             });
 
 
+            // frame timing of the running script.  must be routed before /api/{}
+            m_httpServer->routeBracesGet( "/api/stats",[this](Request* req, Response* resp){
+                m_logger->debug("get /api/stats");
+                JsonRoot* jsonRoot = new JsonRoot;
+                JsonObject* json = jsonRoot->getTopObject();
+                m_executor.getStats(json);
+                ApiResult api(json);
+                api.send(resp);
+                jsonRoot->destroy();
+            });
+
+
             m_httpServer->routeBracesDelete( "/api/script/{}",[this](Request* req, Response* resp){
                 m_logger->debug("delete script");
                 ScriptDataLoader loader;
@@ -13,6 +13,10 @@
 // LOGGING_ON should be 1 to enable logging.  0 optimizes all logging calls and constants (messages) out.
 
 #define LOGGING_ON 1
+
+// FIXED_POINT_HSL should be 1 to convert between HSL and RGB with integer math.  0 uses the float conversions.
+#define FIXED_POINT_HSL 1
+
 #define ADAFRUIT_LED_LOGGER_LEVEL   ERROR_LEVEL
 #define ANIMATION_LOGGER_LEVEL      WARN_LEVEL
 #define API_RESULT_LOGGER_LEVEL     ERROR_LEVEL
@@ -70,7 +74,11 @@
     #define RUN_API_TESTS 0
     #define RUN_APP_STATE_TESTS 0
     #define RUN_SCRIPT_TESTS 0
+    #define RUN_SCRIPT_VALUE_TESTS 0
     #define RUN_TIMER_TESTS 1
+    #define RUN_COLOR_TESTS 0
+    #define RUN_HSL_STRIP_TESTS 0
+    #define RUN_FRAME_SCHEDULER_TESTS 0
 #endif
 
 #endif
\ No newline at end of file
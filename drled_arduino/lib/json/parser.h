@@ -163,7 +163,7 @@ class TokenParser {
         int getCurrentLine(){
             char * nl = strchr(m_data,'\n');
             int p = 1;
-            while(nl > 0 && nl <= m_pos)  {
+            while(nl != NULL && nl <= m_pos)  {
                 nl = strchr(nl+1,'\n');
                 p++;
             }
@@ -173,7 +173,7 @@ class TokenParser {
         int getLineCount(){
             const char * nl = strchr(m_data,'\n');
             int p = 1;
-            while(nl > 0)  {
+            while(nl != NULL)  {
                 nl = strchr(nl+1,'\n');
                 p++;
             }
@@ -94,7 +94,7 @@ namespace DevRelief {
     };
 
  
-    CHSL RGBToHSL(const CRGB&rgb)
+    CHSL RGBToHSLFloat(const CRGB&rgb)
     {
        // double r = rgb.red/255.0;
        // double g = rgb.green/255.0;
@@ -130,6 +130,40 @@ namespace DevRelief {
         return CHSL(h*360,s*100,l*100);
     }
 
+    // integer version of RGBToHSLFloat().  each channel is within 1 of the float version
+    // which can land just below a whole number before it is truncated
+    CHSL RGBToHSLFixed(const CRGB& rgb) {
+        int r = rgb.red;
+        int g = rgb.green;
+        int b = rgb.blue;
+        int maxValue = r > g ? (r > b ? r : b) : (g > b ? g : b);
+        int minValue = r < g ? (r < b ? r : b) : (g < b ? g : b);
+        int sum = maxValue+minValue;
+        int l = sum*100/510;
+        if (maxValue == minValue) {
+            return CHSL(0,0,l);
+        }
+        int d = maxValue-minValue;
+        int s = d*100/(sum > 255 ? 510-sum : sum);
+        int h;
+        if (maxValue == r) {
+            h = (60*(g-b) + (g < b ? 360*d : 0))/d;
+        } else if (maxValue == g) {
+            h = (60*(b-r) + 120*d)/d;
+        } else {
+            h = (60*(r-g) + 240*d)/d;
+        }
+        return CHSL(h,s,l);
+    }
+
+    CHSL RGBToHSL(const CRGB& rgb) {
+#if FIXED_POINT_HSL==1
+        return RGBToHSLFixed(rgb);
+#else
+        return RGBToHSLFloat(rgb);
+#endif
+    }
+
     float HueToRGB(float v1, float v2, float vH) {
         if (vH < 0)
             vH += 1;
@@ -149,7 +183,7 @@ namespace DevRelief {
         return v1;
     }
 
-    CRGB HSLToRGB(const CHSL& hsl) {
+    CRGB HSLToRGBFloat(const CHSL& hsl) {
         //m_logger->debug(hsl to rgb (%d,%d,%d)",(int)hsl.hue,(int)hsl.saturation,(int)hsl.lightness);
         unsigned char r = 0;
         unsigned char g = 0;
@@ -180,6 +214,61 @@ namespace DevRelief {
         return rgb;
     }
 
+    // HueToRGB() is v1+(v2-v1)*shape(hue).  hueShape[h] is shape(h)*60 which is an integer for every degree
+    uint8_t hueShape[360];
+    bool hueShapeInitialized = false;
+
+    void initHueShape() {
+        for(int h=0;h<360;h++) {
+            if (h < 60) {
+                hueShape[h] = h;
+            } else if (h < 180) {
+                hueShape[h] = 60;
+            } else if (h < 240) {
+                hueShape[h] = 240-h;
+            } else {
+                hueShape[h] = 0;
+            }
+        }
+        hueShapeInitialized = true;
+    }
+
+    // (value*HSL_FIXED_SCALE)>>24 == value*255/(10000*60) without a divide.  
+    // value is a lightness*saturation product (0-10000) times a hueShape (0-60)
+    const uint32_t HSL_FIXED_SCALE = 7131;
+
+    // integer version of HSLToRGBFloat().  results are within 1 of the float version
+    CRGB HSLToRGBFixed(const CHSL& hsl) {
+        if (!hueShapeInitialized) {
+            initHueShape();
+        }
+        uint32_t s = hsl.saturation;
+        uint32_t l = hsl.lightness;
+        int hue = hsl.hue >= 360 ? 0 : hsl.hue;
+        // v1 and v2 are the float version's values scaled by 10000
+        uint32_t v2 = (l < 50) ? l*(100+s) : (l+s)*100 - l*s;
+        uint32_t v1 = 200*l - v2;
+        uint32_t base = v1*60;
+        uint32_t range = v2-v1;
+
+        int rhue = hue+120;
+        if (rhue >= 360) { rhue -= 360;}
+        int bhue = hue+240;
+        if (bhue >= 360) { bhue -= 360;}
+        uint8_t r = ((base + range*hueShape[rhue]) * HSL_FIXED_SCALE) >> 24;
+        uint8_t g = ((base + range*hueShape[hue]) * HSL_FIXED_SCALE) >> 24;
+        uint8_t b = ((base + range*hueShape[bhue]) * HSL_FIXED_SCALE) >> 24;
+        return CRGB(r,g,b);
+    }
+
+    CRGB HSLToRGB(const CHSL& hsl) {
+#if FIXED_POINT_HSL==1
+        return HSLToRGBFixed(hsl);
+#else
+        return HSLToRGBFloat(hsl);
+#endif
+    }
+
 
     
 }
@@ -0,0 +1,88 @@
+#ifndef DRLED_OUTPUT_H
+#define DRLED_OUTPUT_H
+#include <Adafruit_NeoPixel.h>
+
+#include "../log/logger.h"
+
+namespace DevRelief {
+
+// sends one strip's pixels to the LEDs.
+// OutputLedStrip draws into an output so the transmitter can be replaced
+// (e.g. a UART or I2S driver, or a simulated wire on the host)
+class ILedOutput {
+    public:
+        virtual ~ILedOutput() {}
+        virtual uint16_t numPixels()=0;
+        virtual int getPin()=0;
+        virtual void clear()=0;
+        virtual void setPixel(uint16_t index, uint8_t red, uint8_t green, uint8_t blue)=0;
+        // the bytes show() sends
+        virtual const uint8_t* getPixels()=0;
+        virtual uint16_t getPixelBytes()=0;
+        virtual void show()=0;
+        // time the last show() spent sending pixels
+        virtual unsigned long getTransmitUsecs()=0;
+};
+
+// creates the output for each configured pin
+class ILedOutputFactory {
+    public:
+        virtual ILedOutput* create(int pin, uint16_t ledCount, neoPixelType pixelType)=0;
+};
+
+// bit-bangs the pixels with Adafruit_NeoPixel.  interrupts are off for the whole show()
+class NeoPixelOutput : public ILedOutput {
+    public:
+        NeoPixelOutput(int pin, uint16_t ledCount, neoPixelType pixelType=NEO_GRB) {
+            m_controller = new Adafruit_NeoPixel(ledCount,pin,pixelType+NEO_KHZ800);
+            // brightness is applied before pixels are set (see BrightnessTable)
+            m_controller->setBrightness(255);
+            m_controller->begin();
+            m_transmitUsecs = 0;
+            // types with a white byte have a white offset different from the red offset
+            int bytesPerPixel = ((pixelType>>6)&3) == ((pixelType>>4)&3) ? 3 : 4;
+            m_pixelBytes = ledCount*bytesPerPixel;
+        }
+
+        ~NeoPixelOutput() {
+            delete m_controller;
+        }
+
+        uint16_t numPixels() override { return m_controller->numPixels();}
+        int getPin() override { return m_controller->getPin();}
+        void clear() override { m_controller->clear();}
+
+        void setPixel(uint16_t index, uint8_t red, uint8_t green, uint8_t blue) override {
+            m_controller->setPixelColor(index,m_controller->Color(red,green,blue));
+        }
+
+        const uint8_t* getPixels() override { return m_controller->getPixels();}
+        uint16_t getPixelBytes() override { return m_pixelBytes;}
+
+        void show() override {
+            unsigned long start = micros();
+            m_controller->show();
+            m_transmitUsecs = micros()-start;
+        }
+
+        unsigned long getTransmitUsecs() override { return m_transmitUsecs;}
+
+    private:
+        Adafruit_NeoPixel* m_controller;
+        unsigned long m_transmitUsecs;
+        uint16_t m_pixelBytes;
+};
+
+class NeoPixelOutputFactory : public ILedOutputFactory {
+    public:
+        static NeoPixelOutputFactory Instance;
+
+        ILedOutput* create(int pin, uint16_t ledCount, neoPixelType pixelType) override {
+            return new NeoPixelOutput(pin,ledCount,pixelType);
+        }
+};
+NeoPixelOutputFactory NeoPixelOutputFactory::Instance;
+
+}
+
+#endif
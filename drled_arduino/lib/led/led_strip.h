@@ -10,6 +10,9 @@
 #define STRIP4_NUMPIXELS STRIP4_LEDS
 #define STRIP4_PIN 2
 
+// CompoundLedStrip stores each LED's strip number in a byte
+#define COMPOUND_MAX_STRIPS 255
+
 //Adafruit_NeoPixel pixels(NUMPIXELS, PIN, NEO_GRB + NEO_KHZ800);
 
 
@@ -17,6 +20,7 @@
 
 #include "../log/interface.h"
 #include "./color.h"
+#include "./led_output.h"
 
 namespace DevRelief {
 
@@ -32,7 +36,17 @@ typedef enum HSLOperation {
     UNSET=999
 };
 
-const int16_t HUE_UNSET=9999;
+// all bits set so a frame can be cleared with memset
+const int16_t HUE_UNSET=-1;
+
+// span writes set one channel for a run of LEDs.  
+// values equal to HSL_SPAN_SKIP leave the LED unchanged
+typedef enum HSLChannel {
+    HSL_HUE=0,
+    HSL_SATURATION=1,
+    HSL_LIGHTNESS=2
+} HSLChannel;
+const int16_t HSL_SPAN_SKIP=-1;
 
 static const char * HSLOPTEXT[]={"replace","add","subtract","average","min","max"};
 
@@ -58,10 +72,13 @@ class CompoundLedStrip;
 
 class IHSLStrip {
     public:
+        virtual ~IHSLStrip() {}
         virtual void setHue(int index, int16_t hue, HSLOperation op=REPLACE)=0;
         virtual void setSaturation(int index, int16_t saturation, HSLOperation op=REPLACE)=0;
         virtual void setLightness(int index, int16_t lightness, HSLOperation op=REPLACE)=0;
         virtual void setRGB(int index, const CRGB& rgb, HSLOperation op=REPLACE)=0;
+        // values[i] is written to LED index+i*step
+        virtual void setSpan(HSLChannel channel, int index, int count, int step, const int16_t* values, HSLOperation op=REPLACE)=0;
         virtual int getCount()=0;
         virtual int getStart()=0;
         virtual void clear()=0;
@@ -90,6 +107,13 @@ class DRLedStrip {
         virtual void setColor(uint16_t index,const CRGB& color)=0;
         virtual int getLEDCount()=0;
         virtual void show()=0;
+        // time the last show() spent sending pixels to the LEDs
+        virtual unsigned long getTransmitUsecs() { return 0;}
+        // frames show() sent to the LEDs and frames it skipped because they were already showing
+        virtual unsigned long getSentFrames() { return 0;}
+        virtual unsigned long getSkippedFrames() { return 0;}
+        // the next show() sends the frame even if it is the last frame sent
+        virtual void resend() {}
 
         virtual void setColor(uint16_t index, CHSL& color) {
             return setColor(index,HSLToRGB(color));
@@ -103,59 +127,180 @@ class DRLedStrip {
         int m_pixelsPerMeter;
 };
 
-class AdafruitLedStrip : public DRLedStrip {
+// maps each 0-255 color channel to its output level for a brightness and gamma.  
+// brightness scales the same way Adafruit_NeoPixel does.  gamma 1 is linear and gamma <= 0 is treated as 1
+class BrightnessTable {
+    public:
+        BrightnessTable() {
+            m_brightness = -1;
+            m_gamma = 1;
+            set(255,1);
+        }
+
+        // the table is only rebuilt if brightness or gamma changed.  returns true if it was
+        bool set(uint8_t brightness, float gamma) {
+            if (!(gamma > 0)) {
+                gamma = 1;
+            }
+            if (brightness == m_brightness && gamma == m_gamma) {
+                return false;
+            }
+            m_brightness = brightness;
+            m_gamma = gamma;
+            uint16_t scale = brightness+1;
+            for(int c=0;c<256;c++) {
+                uint16_t level = c;
+                if (gamma != 1) {
+                    double scaled = pow(c/255.0,gamma)*255+0.5;
+                    level = scaled < 255 ? (uint16_t)scaled : 255;
+                }
+                m_levels[c] = (level*scale) >> 8;
+            }
+            return true;
+        }
+
+        uint8_t getBrightness() const { return m_brightness;}
+        float getGamma() const { return m_gamma;}
+        uint8_t level(uint8_t c) const { return m_levels[c];}
+
+    private:
+        uint8_t m_levels[256];
+        int m_brightness;
+        float m_gamma;
+};
+
+// the output always runs at full brightness.  m_levels scales colors in setColor() 
+// so a brightness change does not rescale the output's pixels.  the output is owned by the strip.
+// show() does not send a frame if it is the same as the last frame sent.  
+// frames are only compared if pixels were written since the last show().  a hash of the output's pixels
+// finds most changed frames and a copy of the last frame sent confirms an unchanged one
+class OutputLedStrip : public DRLedStrip {
     public: 
-        AdafruitLedStrip(int pin, uint16_t ledCount, int pixelsPerMeter, neoPixelType pixelType=NEO_GRB) 
+        OutputLedStrip(ILedOutput* output, int pixelsPerMeter, float gamma=1) 
         :DRLedStrip(pixelsPerMeter) {
             SET_LOGGER(AdafruitLogger);
-            m_logger->debug("create AdafruitLedStrip %d %d",pin,ledCount);
-            
-            m_controller = new Adafruit_NeoPixel(ledCount,pin,pixelType+NEO_KHZ800);
-            m_controller->setBrightness(40);
-            m_controller->begin();
+            m_output = output;
+            m_written = true;
+            m_hasSent = false;
+            m_sentHash = 0;
+            m_sentPixels = NULL;
+            m_skipped = false;
+            m_sentFrames = 0;
+            m_skippedFrames = 0;
+            m_logger->debug("create OutputLedStrip %d %d",m_output->getPin(),m_output->numPixels());
+            m_levels.set(40,gamma);
         }
 
-        ~AdafruitLedStrip() {
-            m_logger->debug("delete AdafruitLedStrip");
-            delete m_controller;
+        ~OutputLedStrip() {
+            m_logger->debug("delete OutputLedStrip");
+            free(m_sentPixels);
+            delete m_output;
         }
 
         virtual void clear() {
-            m_logger->debug("clear AdafruitLedStrip");
-            if (m_controller == NULL) {
-                m_logger->error("NULL controller");
+            m_logger->debug("clear OutputLedStrip");
+            if (m_output == NULL) {
+                m_logger->error("NULL output");
                 return;
             }
-            m_controller->clear();
+            m_written = true;
+            m_output->clear();
         };
+        // pixels already set keep the old brightness until they are set again
         virtual void setBrightness(uint16_t brightness) {
-            m_controller->setBrightness(brightness);
+            m_levels.set(brightness > 255 ? 255 : brightness,m_levels.getGamma());
+        }
+
+        void setGamma(float gamma) {
+            m_levels.set(m_levels.getBrightness(),gamma);
         }
 
         virtual void setColor(uint16_t index, const CRGB& color){
             if (index == 0) {
                 m_logger->debug("setColor  %02X,%02X,%02X",color.red,color.green,color.blue);
             }
-            m_controller->setPixelColor(index,m_controller->Color(color.red,color.green,color.blue));
+            m_written = true;
+            m_output->setPixel(index,m_levels.level(color.red),m_levels.level(color.green),m_levels.level(color.blue));
         }
 
-        virtual int getLEDCount() { return m_controller->numPixels();}
+        virtual int getLEDCount() { return m_output->numPixels();}
         virtual void show() {
-            m_logger->debug("show strip %d, %d",m_controller->getPin(),m_controller->numPixels());
-            //m_controller->setBrightness(40);
-            //m_controller->setPixelColor(10,m_controller->Color(200,100,50));
-            m_controller->show();
+            m_logger->debug("show strip %d, %d",m_output->getPin(),m_output->numPixels());
+            m_skipped = false;
+            if (m_written || !m_hasSent) {
+                uint32_t hash = hashPixels();
+                m_skipped = m_hasSent && hash == m_sentHash && isSent();
+                m_sentHash = hash;
+            } else {
+                m_skipped = true;
+            }
+            m_written = false;
+            if (m_skipped) {
+                m_skippedFrames++;
+                return;
+            }
+            m_output->show();
+            saveSent();
+            m_sentFrames++;
         }
 
+        void resend() override { m_hasSent = false;}
+
+        unsigned long getTransmitUsecs() override { return m_skipped ? 0 : m_output->getTransmitUsecs();}
+        unsigned long getSentFrames() override { return m_sentFrames;}
+        unsigned long getSkippedFrames() override { return m_skippedFrames;}
+
         virtual CompoundLedStrip* getCompoundLedStrip() { return NULL;}
     protected:
-        Adafruit_NeoPixel * m_controller;
+        // FNV-1a
+        uint32_t hashPixels() {
+            const uint8_t* pixels = m_output->getPixels();
+            int bytes = m_output->getPixelBytes();
+            uint32_t h = 2166136261u;
+            for(int i=0;i<bytes;i++) {
+                h = (h ^ pixels[i]) * 16777619u;
+            }
+            return h;
+        }
+
+        // the pixels are the same as the last frame sent
+        bool isSent() {
+            return m_sentPixels != NULL && memcmp(m_sentPixels,m_output->getPixels(),m_output->getPixelBytes()) == 0;
+        }
+
+        // without a copy every frame is sent
+        void saveSent() {
+            int bytes = m_output->getPixelBytes();
+            if (m_sentPixels == NULL) {
+                m_sentPixels = (uint8_t*)malloc(bytes > 0 ? bytes : 1);
+                if (m_sentPixels == NULL) {
+                    m_logger->error("out of memory for %d sent pixel bytes",bytes);
+                }
+            }
+            if (m_sentPixels) {
+                memcpy(m_sentPixels,m_output->getPixels(),bytes);
+            }
+            m_hasSent = true;
+        }
+
+        ILedOutput* m_output;
+        BrightnessTable m_levels;
+        // pixels were set or cleared since the last show()
+        bool m_written;
+        bool m_hasSent;
+        uint32_t m_sentHash;
+        // getPixelBytes() bytes of the last frame sent.  NULL until a frame is sent
+        uint8_t* m_sentPixels;
+        // the last show() did not send the frame
+        bool m_skipped;
+        unsigned long m_sentFrames;
+        unsigned long m_skippedFrames;
 };
 
-class PhyisicalLedStrip : public AdafruitLedStrip {
+class PhyisicalLedStrip : public OutputLedStrip {
     public:
-        PhyisicalLedStrip(int pin, uint16_t ledCount, int pixelsPerMeter, neoPixelType pixelType,uint8_t maxBrightness)
-        : AdafruitLedStrip(pin,ledCount,pixelsPerMeter,pixelType) {
+        PhyisicalLedStrip(ILedOutput* output, int pixelsPerMeter, uint8_t maxBrightness, float gamma=1)
+        : OutputLedStrip(output,pixelsPerMeter,gamma) {
             m_maxBrightness = maxBrightness;
         }
 
@@ -163,119 +308,169 @@ class PhyisicalLedStrip : public AdafruitLedStrip {
             if (brightness > m_maxBrightness) {
                 brightness = m_maxBrightness;
             }
-            m_controller->setBrightness(brightness);
+            OutputLedStrip::setBrightness(brightness);
         }
 
     private:
         uint8_t m_maxBrightness;
 };
 
+// combines any number of strips into one.  
+// m_firstLed[i] is the compound index of strip i's first LED and m_ledStrip maps each
+// compound index to its strip so setColor() does not walk the strips
 class CompoundLedStrip : public DRLedStrip {
     public:
         CompoundLedStrip(int pixelsPerMeter) : DRLedStrip(pixelsPerMeter) {
-            strips[0] = NULL;
-            strips[1] = NULL;
-            strips[2] = NULL;
-            strips[3] = NULL;
-            count = 0;
+            m_strips = NULL;
+            m_firstLed = NULL;
+            m_ledStrip = NULL;
+            m_count = 0;
+            m_ledCount = 0;
             m_logger->info("create CompoundLedStrip");
         }
 
         ~CompoundLedStrip() {
             m_logger->debug("delete CompoundLedStrip");
-            for(int i=0;i<count;i++) {
+            for(int i=0;i<m_count;i++) {
                 m_logger->debug("\tdelete component LedStrip %d",i);
-                delete strips[i];
+                delete m_strips[i];
             }
+            free(m_strips);
+            free(m_firstLed);
+            free(m_ledStrip);
         }
 
         /* this always returns the value of the first strip which may result
          * in incorrect calculations if multiple strips exist with different values */
         int getPixelsPerMeter() override {
-            if (count == 0) { return 0;}
-            return strips[0]->getPixelsPerMeter();
+            if (m_count == 0) { return 0;}
+            return m_strips[0]->getPixelsPerMeter();
         }
 
-        void add(DRLedStrip * strip) {
-            if (count < 4) {
-                strips[count++] = strip;
-            } else {
+        // returns false if the strip is not added.  the caller still owns it then
+        bool add(DRLedStrip * strip) {
+            if (strip == NULL) {
+                m_logger->error("NULL strip added to CompoundLedStrip");
+                return false;
+            }
+            if (m_count >= COMPOUND_MAX_STRIPS) {
                 m_logger->error("too many strips added to CompoundLedStrip");
+                return false;
+            }
+            // a table that grows is kept even if a later one fails.  m_count is only changed when all grow
+            DRLedStrip** strips = (DRLedStrip**)realloc(m_strips,sizeof(DRLedStrip*)*(m_count+1));
+            if (strips == NULL) {
+                m_logger->error("out of memory adding strip %d to CompoundLedStrip",m_count);
+                return false;
+            }
+            m_strips = strips;
+            int* firstLed = (int*)realloc(m_firstLed,sizeof(int)*(m_count+2));
+            if (firstLed == NULL) {
+                m_logger->error("out of memory adding strip %d to CompoundLedStrip",m_count);
+                return false;
+            }
+            m_firstLed = firstLed;
+            int ledCount = m_ledCount + strip->getLEDCount();
+            uint8_t* ledStrip = (uint8_t*)realloc(m_ledStrip,ledCount > 0 ? ledCount : 1);
+            if (ledStrip == NULL) {
+                m_logger->error("out of memory for %d LEDs in CompoundLedStrip",ledCount);
+                return false;
             }
+            m_ledStrip = ledStrip;
+            m_strips[m_count++] = strip;
+            buildIndexMap();
+            return true;
         }
 
         
         void clear() {
-            m_logger->debug("clear() %d components",count);
-            for(int i=0;i<count;i++) {
-                if (strips[i] == NULL) {
-                    m_logger->error("NULL component script %d",i);
-                } else {
-                    //m_logger->debug("clear strip %d",i);
-                    strips[i]->clear();
-                }
+            m_logger->debug("clear() %d components",m_count);
+            for(int i=0;i<m_count;i++) {
+                m_strips[i]->clear();
             }
         };
         virtual void setBrightness(uint16_t brightness) {
-            for(int i=0;i<count;i++) {
-                strips[i]->setBrightness(brightness);
+            for(int i=0;i<m_count;i++) {
+                m_strips[i]->setBrightness(brightness);
             }
         };
 
         virtual void setColor(uint16_t index,const CRGB& color)  {
-            int strip = 0;
-            uint16_t oindex = index;
-            while(strip < count && strip < 4 && strips[strip] != NULL && index >= strips[strip]->getLEDCount()) {
-                index -= strips[strip]->getLEDCount();
-                strip++;
-            }
-            if (strip >= count || strip >= 4) {
-                m_logger->error("strip too big %d %d",strip,oindex);
+            if (index >= m_ledCount) {
+                m_logger->error("strip too big %d %d",index,m_ledCount);
                 return;
             }
+            int strip = m_ledStrip[index];
+            m_strips[strip]->setColor(index-m_firstLed[strip],color);
+        };
 
-            if (strips[strip] == NULL) {
-                m_logger->error("missing strip %d %d",oindex,strip);
-                return;
+        virtual int getLEDCount() {
+            return m_ledCount;
+        }
+
+        virtual void show() {
+            m_logger->debug("show() %d",m_count);
+            for(int i=0;i<m_count;i++) {
+                m_strips[i]->show();
             }
+        }
 
-            // if (index == 0) {
-            //     m_logger->error("set color %d %d %d %d: %d,%d,%d",index,count,strips[strip]->getCount(),strip,color.red,color.green,color.blue);
-            // }
-            if (index<strips[strip]->getLEDCount()){
-                strips[strip]->setColor(index,color);
-            } else {
-                m_logger->error("bad index %d %d %d",index,strip,(strips[strip] == NULL ? -1 : strips[strip]->getLEDCount()));
+        // the strips are sent one after another
+        unsigned long getTransmitUsecs() override {
+            unsigned long usecs = 0;
+            for(int i=0;i<m_count;i++) {
+                usecs += m_strips[i]->getTransmitUsecs();
             }
-        };
-        virtual int getLEDCount() {
-            size_t ledcount = 0;
-            for(int i=0;i<count;i++) {
-                if (strips[i] == NULL) {
-                    m_logger->error("strip %d is NULL",i);
-                } else {
-                   // m_logger->debug("get count strip %d",i);
-                    ledcount += strips[i]->getLEDCount();
-                }
+            return usecs;
+        }
+
+        unsigned long getSentFrames() override {
+            unsigned long frames = 0;
+            for(int i=0;i<m_count;i++) {
+                frames += m_strips[i]->getSentFrames();
             }
-            m_logger->never("getLEDCount()=%d",ledcount);
-            return ledcount;
+            return frames;
         }
 
-        virtual void show() {
-            m_logger->debug("show() %d",count);
-            for(int i=0;i<count;i++) {
-                strips[i]->show();
+        unsigned long getSkippedFrames() override {
+            unsigned long frames = 0;
+            for(int i=0;i<m_count;i++) {
+                frames += m_strips[i]->getSkippedFrames();
             }
+            return frames;
         }
 
-        DRLedStrip* getStripNumber(int i) { return strips[i];}
+        void resend() override {
+            for(int i=0;i<m_count;i++) {
+                m_strips[i]->resend();
+            }
+        }
+
+        int getStripCount() { return m_count;}
+        DRLedStrip* getStripNumber(int i) { return (i >= 0 && i < m_count) ? m_strips[i] : NULL;}
 
         virtual CompoundLedStrip* getCompoundLedStrip() { return this;}
 
     private:
-        DRLedStrip* strips[4]; // max of 4 strips;
-        size_t      count;
+        // component LED counts do not change after they are added.
+        // add() has already grown the tables for m_count strips
+        void buildIndexMap() {
+            m_firstLed[0] = 0;
+            for(int i=0;i<m_count;i++) {
+                m_firstLed[i+1] = m_firstLed[i] + m_strips[i]->getLEDCount();
+            }
+            m_ledCount = m_firstLed[m_count];
+            m_logger->debug("CompoundLedStrip %d strips %d LEDs",m_count,m_ledCount);
+            for(int i=0;i<m_count;i++) {
+                memset(m_ledStrip+m_firstLed[i],i,m_firstLed[i+1]-m_firstLed[i]);
+            }
+        }
+
+        DRLedStrip** m_strips;
+        int*        m_firstLed; // m_count+1 entries.  the last is the total LED count
+        uint8_t*    m_ledStrip; // strip number of each LED
+        int         m_count;
+        int         m_ledCount;
 };
 
 class AlteredStrip : public DRLedStrip {
@@ -302,6 +497,10 @@ class AlteredStrip : public DRLedStrip {
 
         virtual int getLEDCount() { return translateCount(m_base ? m_base->getLEDCount() : 0);}
         virtual void show() {m_base->show();}
+        unsigned long getTransmitUsecs() override { return m_base ? m_base->getTransmitUsecs() : 0;}
+        unsigned long getSentFrames() override { return m_base ? m_base->getSentFrames() : 0;}
+        unsigned long getSkippedFrames() override { return m_base ? m_base->getSkippedFrames() : 0;}
+        void resend() override { if (m_base) { m_base->resend();}}
         virtual CompoundLedStrip* getCompoundLedStrip() { return m_base ? m_base->getCompoundLedStrip() : NULL;}
 
     protected:
@@ -345,6 +544,173 @@ class RotatedStrip: public AlteredStrip {
 
 
 
+// SWAR (SIMD within a register) helpers for 4 saturation or lightness bytes in a 32 bit word.
+// the ESP8266 has no SIMD instructions.  blended values are in [0,100] so bit 7 of each byte 
+// is free to catch the borrow of a per-byte compare
+#define SWAR_ONES 0x01010101u
+#define SWAR_HIGH 0x80808080u
+
+// 0xFF in each byte that has bit 7 set
+inline uint32_t swarHighMask(uint32_t x) { return ((x & SWAR_HIGH) >> 7) * 0xFFu;}
+
+// 0xFF in each byte where a >= b.  bytes of a and b must be in [0,127]
+inline uint32_t swarGreaterEqual(uint32_t a, uint32_t b) { return swarHighMask((a | SWAR_HIGH) - b);}
+
+// blend kernels for each HSLOperation.  HSLStrip::setSpan() picks one per span so the loop over LEDs
+// has no switch.  results match HSLStrip::performOperation(): an unset (negative) current value 
+// is replaced by the operand, or 0 for SUBTRACT.
+// blend4() does the same for 4 bytes in [0,100] and clamps the results to [0,100]
+struct BlendReplace {
+    static int16_t blend(int16_t current, int16_t operand) { return operand;}
+    static uint32_t blend4(uint32_t current, uint32_t operand) { return operand;}
+};
+
+struct BlendAdd {
+    static int16_t blend(int16_t current, int16_t operand) { return current < 0 ? operand : current+operand;}
+    static uint32_t blend4(uint32_t current, uint32_t operand) {
+        // sums are at most 200 so they do not carry into the next byte
+        uint32_t over = swarGreaterEqual(current,101*SWAR_ONES-operand);
+        return ((current+operand) & ~over) | (100*SWAR_ONES & over);
+    }
+};
+
+struct BlendSubtract {
+    static int16_t blend(int16_t current, int16_t operand) { return current < 0 ? 0 : current-operand;}
+    static uint32_t blend4(uint32_t current, uint32_t operand) {
+        uint32_t difference = (current | SWAR_HIGH) - operand;
+        return difference & ~SWAR_HIGH & swarHighMask(difference);
+    }
+};
+
+struct BlendAverage {
+    static int16_t blend(int16_t current, int16_t operand) { return current < 0 ? operand : (current+operand)/2;}
+    static uint32_t blend4(uint32_t current, uint32_t operand) {
+        return (current & operand) + (((current ^ operand) & 0xFEFEFEFEu) >> 1);
+    }
+};
+
+struct BlendMin {
+    static int16_t blend(int16_t current, int16_t operand) { return current < 0 || operand < current ? operand : current;}
+    static uint32_t blend4(uint32_t current, uint32_t operand) {
+        uint32_t useOperand = swarGreaterEqual(current,operand);
+        return (operand & useOperand) | (current & ~useOperand);
+    }
+};
+
+struct BlendMax {
+    static int16_t blend(int16_t current, int16_t operand) { return current < 0 || operand > current ? operand : current;}
+    static uint32_t blend4(uint32_t current, uint32_t operand) {
+        uint32_t useCurrent = swarGreaterEqual(current,operand);
+        return (current & useCurrent) | (operand & ~useCurrent);
+    }
+};
+
+// saturation or lightness after one write.  operands outside [0,100] are ignored
+// and an unset (-1) value starts at unsetValue
+template<class Blend>
+int8_t blendByte(int8_t current, int16_t operand, int8_t unsetValue) {
+    if (operand < 0 || operand > 100) { return current;}
+    int16_t value = Blend::blend(current == -1 ? unsetValue : current,operand);
+    return value < 0 ? 0 : value > 100 ? 100 : value;
+}
+
+// blendByte() for a run of bytes.  4 bytes are blended at once from the first 4 byte boundary
+template<class Blend>
+void blendBytes(int8_t* current, int count, const int16_t* operands, int8_t unsetValue) {
+    int i = 0;
+    for(;i<count && ((uintptr_t)(current+i) & 3) != 0;i++) {
+        current[i] = blendByte<Blend>(current[i],operands[i],unsetValue);
+    }
+    for(;i+4<=count;i+=4) {
+        uint8_t operandBytes[4];
+        uint8_t validBytes[4];
+        for(int b=0;b<4;b++) {
+            int16_t operand = operands[i+b];
+            bool valid = operand >= 0 && operand <= 100;
+            operandBytes[b] = valid ? operand : 0;
+            validBytes[b] = valid ? 0xFF : 0;
+        }
+        uint32_t word, operand, valid;
+        memcpy(&valid,validBytes,4);
+        if (valid == 0) { continue;}
+        memcpy(&word,current+i,4);
+        memcpy(&operand,operandBytes,4);
+        uint32_t unset = swarHighMask(word);
+        uint32_t value = (word & ~unset) | ((uint8_t)unsetValue*SWAR_ONES & unset);
+        value = Blend::blend4(value,operand);
+        word = (value & valid) | (word & ~valid);
+        memcpy(current+i,&word,4);
+    }
+    for(;i<count;i++) {
+        current[i] = blendByte<Blend>(current[i],operands[i],unsetValue);
+    }
+}
+
+// one allocation holding two HSL frames as separate hue, saturation and lightness arrays.
+// the front frame is drawn.  the back frame is the previous frame.
+class HSLFrameStore {
+    public:
+        HSLFrameStore() {
+            m_count = 0;
+            m_data = NULL;
+            m_front = 0;
+            SET_LOGGER(HSLStripLogger);
+        }
+
+        ~HSLFrameStore() {
+            free(m_data);
+        }
+
+        // keeps the current memory if the count did not change
+        void allocate(int count) {
+            if (count == m_count && (m_data != NULL || count == 0)) {
+                return;
+            }
+            m_logger->debug("HSLFrameStore allocate %d",count);
+            free(m_data);
+            m_data = NULL;
+            m_count = 0;
+            if (count > 0) {
+                m_data = (uint8_t*) malloc(getFrameSize(count)*2);
+                if (m_data == NULL) {
+                    m_logger->error("HSLFrameStore out of memory for %d LEDs",count);
+                    return;
+                }
+                m_count = count;
+                memset(m_data,-1,getFrameSize(count)*2);
+            }
+            m_front = 0;
+        }
+
+        void swap() { m_front = 1-m_front;}
+        void clearFront() {
+            if (m_data == NULL) { return;}
+            memset(getHue(m_front),-1,sizeof(int16_t)*m_count);
+            memset(getSaturation(m_front),-1,sizeof(int8_t)*m_count);
+            memset(getLightness(m_front),-1,sizeof(int8_t)*m_count);
+        }
+
+        int getCount() { return m_count;}
+        int16_t* getFrontHue() { return getHue(m_front);}
+        int8_t* getFrontSaturation() { return getSaturation(m_front);}
+        int8_t* getFrontLightness() { return getLightness(m_front);}
+        int16_t* getBackHue() { return getHue(1-m_front);}
+        int8_t* getBackSaturation() { return getSaturation(1-m_front);}
+        int8_t* getBackLightness() { return getLightness(1-m_front);}
+
+    protected:
+        // layout is hue[2][count], saturation[2][count], lightness[2][count]
+        static size_t getFrameSize(int count) { return count*(sizeof(int16_t)+sizeof(int8_t)*2);}
+        int16_t* getHue(int frame) { return m_data ? ((int16_t*)m_data)+frame*m_count : NULL;}
+        int8_t* getSaturation(int frame) { return m_data ? ((int8_t*)(m_data+sizeof(int16_t)*2*m_count))+frame*m_count : NULL;}
+        int8_t* getLightness(int frame) { return m_data ? ((int8_t*)(m_data+(sizeof(int16_t)+sizeof(int8_t))*2*m_count))+frame*m_count : NULL;}
+
+        DECLARE_LOGGER();
+        int m_count;
+        uint8_t* m_data;
+        int m_front;
+};
+
 class HSLStrip: public AlteredStrip, public IHSLStrip{
     public:
         HSLStrip(DRLedStrip* base): AlteredStrip(base) { 
@@ -352,12 +718,36 @@ class HSLStrip: public AlteredStrip, public IHSLStrip{
             m_hue = NULL;
             m_saturation = NULL;
             m_lightness = NULL;
+            m_prevHue = NULL;
+            m_prevSaturation = NULL;
+            m_prevLightness = NULL;
+            m_prevValid = false;
+            m_frontShown = false;
+            m_dirtyStart = 0;
+            m_dirtyEnd = 0;
+            m_prevDirtyStart = 0;
+            m_prevDirtyEnd = 0;
+            m_pixelsConverted = 0;
             SET_LOGGER(HSLStripLogger);
             m_logger->debug("created HSLStrip with base 0x%04X",base);
         }
 
         ~HSLStrip() {
-            reallocHSLData(0);
+        }
+
+        // allocate both frames for the base strip's LEDs.  
+        // clear() does this if the count changes but it is better done once at setup
+        void allocateFrames() {
+            int count = m_base ? m_base->getLEDCount() : 0;
+            m_frames.allocate(count);
+            m_prevValid = false;
+            m_frontShown = false;
+            m_count = m_frames.getCount();
+            m_dirtyStart = 0;
+            m_dirtyEnd = m_count;
+            m_prevDirtyStart = 0;
+            m_prevDirtyEnd = m_count;
+            useFrames();
         }
 
         virtual int getStart() override { return 0;}
@@ -365,11 +755,22 @@ class HSLStrip: public AlteredStrip, public IHSLStrip{
         int getPixelsPerMeter() {
             return m_base->getPixelsPerMeter();
         }
+        // setHSL() checks the index
         void setRGB(int index, const CRGB& rgb,HSLOperation op) {
-            CHSL hsl = RGBToHSL(rgb);
-            setHue(index,hsl.hue,op);
-            setSaturation(index,hsl.saturation,op);
-            setLightness(index,hsl.lightness,op);
+            setHSL(index,RGBToHSL(rgb),op);
+        }
+
+        // same as setHue(), setSaturation() and setLightness() with one range check.  CHSL values are always in range
+        void setHSL(int index, const CHSL& hsl, HSLOperation op=REPLACE) {
+            if (index<0 || index>=m_count) {
+                return;
+            } 
+            markDirty(index);
+            m_hue[index] = wrapHue(performOperation(op,m_hue[index],hsl.hue),hsl.hue);
+            int16_t saturation = m_saturation[index] == -1 ? 100 : m_saturation[index];
+            m_saturation[index] = clamp(0,100,performOperation(op,saturation,hsl.saturation));
+            int16_t lightness = m_lightness[index] == -1 ? 50 : m_lightness[index];
+            m_lightness[index] = clamp(0,100,performOperation(op,lightness,hsl.lightness));
         }
 
         void setHue(int index, int16_t hue, HSLOperation op=REPLACE) {
@@ -381,15 +782,8 @@ class HSLStrip: public AlteredStrip, public IHSLStrip{
                 m_logger->never("hue %d %d",index,hue);
             }
             //m_hue[index] = clamp(0,359,performOperation(op,m_hue[index],hue));
-            int16_t h = performOperation(op,m_hue[index],hue);
-            if (h<0) {
-                h = 360-(hue%360);
-            }
-            h = h % 360;
-
-            m_logger->debug("Hue %d %d=>%d  op=%d",index,m_hue[index],hue,op);
-
-            m_hue[index] = h;
+            markDirty(index);
+            m_hue[index] = wrapHue(performOperation(op,m_hue[index],hue),hue);
 
             if (index == 0) {
                 //m_logger->periodicNever(ERROR_LEVEL,5000,"setHue %d %d %d",index,hue,op);
@@ -401,6 +795,7 @@ class HSLStrip: public AlteredStrip, public IHSLStrip{
                 return;
             } 
             if (saturation<0 || saturation>100) { return;}
+            markDirty(index);
             int s = m_saturation[index];
             if (m_saturation[index] == -1) {
                 m_saturation[index] = 100; // set default before doing op
@@ -409,6 +804,37 @@ class HSLStrip: public AlteredStrip, public IHSLStrip{
             m_logger->debug("Saturation op=%d index=%d %d=>%d",op,index,s,m_saturation[index]);
         }
 
+        void setSpan(HSLChannel channel, int index, int count, int step, const int16_t* values, HSLOperation op=REPLACE) {
+            if (!clipSpan(index,count,step,values)) { return;}
+            switch(op) {
+                case REPLACE: blendSpan<BlendReplace>(channel,index,count,step,values); return;
+                case ADD: blendSpan<BlendAdd>(channel,index,count,step,values); return;
+                case SUBTRACT: blendSpan<BlendSubtract>(channel,index,count,step,values); return;
+                case AVERAGE: blendSpan<BlendAverage>(channel,index,count,step,values); return;
+                case MIN: blendSpan<BlendMin>(channel,index,count,step,values); return;
+                case MAX: blendSpan<BlendMax>(channel,index,count,step,values); return;
+                default: break;
+            }
+            // other operations go through performOperation() one LED at a time
+            switch(channel) {
+                case HSL_HUE:
+                    for(int i=0;i<count;i++,index+=step) {
+                        if (values[i] != HSL_SPAN_SKIP) { HSLStrip::setHue(index,values[i],op);}
+                    }
+                    break;
+                case HSL_SATURATION:
+                    for(int i=0;i<count;i++,index+=step) {
+                        if (values[i] != HSL_SPAN_SKIP) { HSLStrip::setSaturation(index,values[i],op);}
+                    }
+                    break;
+                case HSL_LIGHTNESS:
+                    for(int i=0;i<count;i++,index+=step) {
+                        if (values[i] != HSL_SPAN_SKIP) { HSLStrip::setLightness(index,values[i],op);}
+                    }
+                    break;
+            }
+        }
+
         void setLightness(int index, int16_t lightness, HSLOperation op=REPLACE) {
             if (index<=5) {
                 m_logger->never("HSL Lightness op %d %d %d",op,index,lightness);
@@ -418,6 +844,7 @@ class HSLStrip: public AlteredStrip, public IHSLStrip{
             } 
             
             if (lightness<0 || lightness>100) { return;}
+            markDirty(index);
             if (m_lightness[index] == -1) {
                 m_lightness[index] = 50; // set default before doing op
             }
@@ -432,25 +859,54 @@ class HSLStrip: public AlteredStrip, public IHSLStrip{
                 return;
             }
             m_logger->debug("Clear HSLStrip");
-            int count = m_base->getLEDCount();
-            m_logger->debug("HSLStrip realloc for %d leds",count);
-            reallocHSLData(count);
-            m_logger->debug("clear HSL values");
-            for(int i=0;i<count;i++) {
-                m_hue[i] = HUE_UNSET;
+            if (m_base->getLEDCount() != m_count) {
+                m_logger->debug("HSLStrip LED count changed");
+                allocateFrames();
             }
-            //memset(m_hue,-1,sizeof(int16_t)*count);
-            memset(m_saturation,-1,sizeof(int8_t)*count);
-            memset(m_lightness,-1,sizeof(int8_t)*count);
-            //m_base->clear();
+            // the frame just drawn becomes the previous frame.  
+            // it can only be used to skip LEDs if it was sent to the base strip
+            m_prevValid = m_frontShown;
+            m_frontShown = false;
+            m_frames.swap();
+            m_frames.clearFront();
+            useFrames();
+            m_prevDirtyStart = m_dirtyStart;
+            m_prevDirtyEnd = m_dirtyEnd;
+            m_dirtyStart = m_count;
+            m_dirtyEnd = 0;
         }
 
+        // the next show() converts every LED.  needed if something else changed the base strip's pixels
+        void invalidate() {
+            m_prevValid = false;
+            m_frontShown = false;
+        }
+
+        void setBrightness(uint16_t brightness) override {
+            invalidate();
+            m_base->setBrightness(brightness);
+        }
+
+        // only LEDs written this frame or the previous frame can change.  
+        // those are converted if their HSL value is different from the previous frame's.
+        // LEDs outside both ranges are clear in both frames
         void show() {
             m_logger->never("show() %d",m_count);
-            for(int idx=0;idx<m_count;idx++) {
+            int start = 0;
+            int end = m_count;
+            if (m_prevValid) {
+                start = m_dirtyStart < m_prevDirtyStart ? m_dirtyStart : m_prevDirtyStart;
+                end = m_dirtyEnd > m_prevDirtyEnd ? m_dirtyEnd : m_prevDirtyEnd;
+            }
+            m_pixelsConverted = 0;
+            for(int idx=start;idx<end;idx++) {
                 int hue = m_hue[idx];
                 int sat = m_saturation[idx];
                 int light = m_lightness[idx];
+                if (m_prevValid && hue == m_prevHue[idx] && sat == m_prevSaturation[idx] && light == m_prevLightness[idx]) {
+                    continue;
+                }
+                m_pixelsConverted++;
                 if (hue == HUE_UNSET) {
                     light = 0;
                 }
@@ -464,34 +920,28 @@ class HSLStrip: public AlteredStrip, public IHSLStrip{
                 }
                 m_base->setColor(idx,hsl);
             }
+            // a second show() without clear() must not skip LEDs that changed since the first
+            m_prevValid = false;
+            m_frontShown = m_count > 0;
             m_base->show();
         }
 
+        // number of LEDs converted to RGB by the last show()
+        int getPixelsConverted() { return m_pixelsConverted;}
+
         int getLEDCount() { return m_base->getLEDCount();}
         int getCount() { return m_base->getLEDCount();}
         virtual IHSLStrip* getFirstHSLStrip() { return this;}
         virtual CompoundLedStrip* getCompoundLedStrip() { return m_base?m_base->getCompoundLedStrip() : NULL;}
 
     protected:
-        void reallocHSLData(int count) {
-            if ((count == 0 || count > m_count) && m_hue != NULL) {
-                m_logger->debug("HSLStrip free %d %d",count,m_count);
-                free(m_hue);
-                free(m_saturation);
-                free(m_lightness);
-                m_hue = NULL;
-                m_saturation = NULL;
-                m_lightness = NULL;
-            }
-            if (count > 0 && m_hue == NULL) {
-                m_logger->debug("HSLStrip malloc %d ",count);
-                m_hue = (int16_t*) malloc(sizeof(int16_t)*count);
-                m_saturation = (int8_t*) malloc(sizeof(int8_t)*count);
-                m_lightness = (int8_t*) malloc(sizeof(int8_t)*count);
-                m_count = count;
-            } else {
-                m_logger->debug("no need to malloc members %d",count);
-            }
+        void useFrames() {
+            m_hue = m_frames.getFrontHue();
+            m_saturation = m_frames.getFrontSaturation();
+            m_lightness = m_frames.getFrontLightness();
+            m_prevHue = m_frames.getBackHue();
+            m_prevSaturation = m_frames.getBackSaturation();
+            m_prevLightness = m_frames.getBackLightness();
         }
 
         int16_t defaultValue(int min, int max, int val, int def) {
@@ -510,9 +960,75 @@ class HSLStrip: public AlteredStrip, public IHSLStrip{
             }
             return val;
         }
+        void markDirty(int index) {
+            if (index < m_dirtyStart) { m_dirtyStart = index;}
+            if (index >= m_dirtyEnd) { m_dirtyEnd = index+1;}
+        }
+
+        // limit a span to the LEDs in the strip.  returns false if none are
+        bool clipSpan(int& index, int& count, int step, const int16_t*& values) {
+            if (count <= 0) { return false;}
+            if (step == 0) { return index >= 0 && index < m_count;}
+            int last = index+(count-1)*step;
+            int skip = 0;
+            if (step > 0) {
+                if (index < 0) { skip = (-index+step-1)/step;}
+                if (last >= m_count) { count -= (last-m_count)/step+1;}
+            } else {
+                if (index >= m_count) { skip = (index-m_count-step)/(-step);}
+                if (last < 0) { count -= (-last-1)/(-step)+1;}
+            }
+            index += skip*step;
+            values += skip;
+            count -= skip;
+            return count > 0;
+        }
+
+        // the span is already clipped to the strip
+        template<class Blend>
+        void blendSpan(HSLChannel channel, int index, int count, int step, const int16_t* values) {
+            int last = index+(count-1)*step;
+            markDirty(index < last ? index : last);
+            markDirty(index < last ? last : index);
+            switch(channel) {
+                case HSL_HUE:
+                    for(int i=0;i<count;i++,index+=step) {
+                        int16_t hue = values[i];
+                        if (hue == HSL_SPAN_SKIP) { continue;}
+                        m_hue[index] = wrapHue(Blend::blend(m_hue[index],hue),hue);
+                    }
+                    break;
+                case HSL_SATURATION:
+                    if (step == 1) {
+                        blendBytes<Blend>(m_saturation+index,count,values,100);
+                        break;
+                    }
+                    for(int i=0;i<count;i++,index+=step) {
+                        m_saturation[index] = blendByte<Blend>(m_saturation[index],values[i],100);
+                    }
+                    break;
+                case HSL_LIGHTNESS:
+                    if (step == 1) {
+                        blendBytes<Blend>(m_lightness+index,count,values,50);
+                        break;
+                    }
+                    for(int i=0;i<count;i++,index+=step) {
+                        m_lightness[index] = blendByte<Blend>(m_lightness[index],values[i],50);
+                    }
+                    break;
+            }
+        }
+
+        // a negative result takes its hue from the operand.  the modulo is only needed past 359
+        int16_t wrapHue(int16_t hue, int16_t operand) {
+            if (hue < 0) {
+                hue = 360-(operand%360);
+            }
+            return hue < 360 ? hue : hue % 360;
+        }
+
         int16_t performOperation(HSLOperation op, int16_t currentValue, int16_t operand)
         {
-            m_logger->debug("HSLStrip.performOperation %d %d %d",op,currentValue,operand);
             if (currentValue < 0 || currentValue == HUE_UNSET) {
                 return (op == SUBTRACT) ? 0 : operand;
             }
@@ -539,12 +1055,85 @@ class HSLStrip: public AlteredStrip, public IHSLStrip{
 
     private:
         uint16_t m_count;
+        HSLFrameStore m_frames;
+        // front frame
         int16_t * m_hue;
         int8_t  * m_saturation;
         int8_t  * m_lightness;
+        // back frame.  the previous frame
+        int16_t * m_prevHue;
+        int8_t  * m_prevSaturation;
+        int8_t  * m_prevLightness;
+        // the base strip has the back frame's colors
+        bool m_prevValid;
+        // the front frame was sent to the base strip
+        bool m_frontShown;
+        // range of LEDs written since clear() [start,end)
+        int m_dirtyStart;
+        int m_dirtyEnd;
+        int m_prevDirtyStart;
+        int m_prevDirtyEnd;
+        int m_pixelsConverted;
         HSLOperation m_op;
 };
 
+// writes RGB colors straight to the base strip's pixels.  
+// only for scripts where every LED is replaced by an RGB color (Script::isRGBDirect()) 
+// so there is no HSL frame to blend or convert.  HSL writes are dropped and logged once.
+// the base strip is not owned
+class RGBStrip : public IHSLStrip {
+    public:
+        RGBStrip(DRLedStrip* base) {
+            SET_LOGGER(HSLStripLogger);
+            m_base = base;
+            m_count = base ? base->getLEDCount() : 0;
+            m_hslDropped = false;
+        }
+
+        void setHue(int index, int16_t hue, HSLOperation op=REPLACE) { dropHSL("hue");}
+        void setSaturation(int index, int16_t saturation, HSLOperation op=REPLACE) { dropHSL("saturation");}
+        void setLightness(int index, int16_t lightness, HSLOperation op=REPLACE) { dropHSL("lightness");}
+        void setSpan(HSLChannel channel, int index, int count, int step, const int16_t* values, HSLOperation op=REPLACE) { dropHSL("span");}
+
+        void setRGB(int index, const CRGB& rgb, HSLOperation op=REPLACE) {
+            if (index<0 || index>=m_count) {
+                return;
+            } 
+            m_base->setColor(index,rgb);
+        }
+
+        int getCount() { return m_count;}
+        int getStart() { return 0;}
+        int getPixelsPerMeter() { return m_base ? m_base->getPixelsPerMeter() : 30;}
+
+        void clear() {
+            if (m_base == NULL) {
+                m_logger->warn("RGBStrip does not have a base");
+                return;
+            }
+            m_count = m_base->getLEDCount();
+            m_base->clear();
+        }
+
+        void show() {
+            if (m_base) { m_base->show();}
+        }
+
+    private:
+        // an element that is not RGB direct drew to this strip.  its LEDs are lost
+        void dropHSL(const char * channel) {
+            if (!m_hslDropped) {
+                m_logger->error("RGBStrip cannot draw %s.  the element is not RGB direct",channel);
+                m_hslDropped = true;
+            }
+        }
+
+        DECLARE_LOGGER();
+        DRLedStrip* m_base;
+        int m_count;
+        bool m_hslDropped;
+};
+
 // derive from this class to create a filter that only does one thing (e.g. hue)
 // the default implementation of all IHSLStrip methods just pass through
 // to the base strip
@@ -561,6 +1150,7 @@ class HSLFilter : public DRLedStrip, IHSLStrip {
         void setSaturation(int index, int16_t saturation, HSLOperation op=REPLACE) { if (m_base) { m_base->setSaturation(index,saturation,op);}}
         void setLightness(int index, int16_t lightness, HSLOperation op=REPLACE) { if (m_base) { m_base->setLightness(index,lightness,op);}}
         void setRGB(int index, const CRGB& rgb, HSLOperation op=REPLACE) { if (m_base) { m_base->setRGB(index,rgb,op);}}
+        void setSpan(HSLChannel channel, int index, int count, int step, const int16_t* values, HSLOperation op=REPLACE) { if (m_base) { m_base->setSpan(channel,index,count,step,values,op);}}
         int getCount() { if (m_base) { return m_base->getCount();} else return 0;}
         int getLEDCount() { if (m_base) { return m_base->getCount();} else return 0;}
         int getStart() { if (m_base) { return m_base->getStart();} else return 0;}
@@ -41,11 +41,11 @@
             }
 
             long getFreeHeap() { 
-                return 0;
+                return maxHeap-allocatedHeap;
             }
 
             long getMaxFreeBlockSize() {
-                return 0;
+                return maxHeap-allocatedHeap;
             }
 
             long getHeapFragmentation() {
@@ -54,9 +54,7 @@
 
             long currentMsecs() {
                 auto now = std::chrono::high_resolution_clock::now();
-                duration<double> sinceStart = now-processStartTime;
-                long msecs = (long)sinceStart.count();
-                printf("ms: %d",msecs);
+                long msecs = (long)duration_cast<milliseconds>(now-processStartTime).count();
                 return msecs;
             }
 
@@ -271,7 +271,11 @@ class DRFormattedString : public DRString{
     private:
         void formatString(const char * format, va_list args) {
             char buf[2];
-            int len = vsnprintf(buf,1,format,args)+1;
+            // args cannot be used twice.  measure with a copy
+            va_list measureArgs;
+            va_copy(measureArgs,args);
+            int len = vsnprintf(buf,1,format,measureArgs)+1;
+            va_end(measureArgs);
             m_data.get()->ensureLength(len+1);
             vsnprintf(m_data.get()->data(),len,format,args);
         }
@@ -0,0 +1,56 @@
+#ifndef DR_RANDOM_H
+#define DR_RANDOM_H
+
+#include <stdint.h>
+
+namespace DevRelief {
+
+// xorshift32 generator.  cheap enough to call for every LED.
+// the same seed always gives the same values so a script run can be replayed
+class Random {
+    public:
+        static Random Instance;
+
+        Random(uint32_t seed=1) {
+            setSeed(seed);
+        }
+
+        void setSeed(uint32_t seed) {
+            // spread small seeds over the state.  0 would only ever return 0
+            m_state = (seed ^ 0x9E3779B9) * 2654435761u;
+            if (m_state == 0) {
+                m_state = 1;
+            }
+        }
+
+        uint32_t next() {
+            uint32_t x = m_state;
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            m_state = x;
+            return x;
+        }
+
+        // same ranges as Arduino random().  0 <= value < high
+        long random(long high) {
+            return random(0,high);
+        }
+
+        // low <= value < high
+        long random(long low, long high) {
+            if (high <= low) {
+                return low;
+            }
+            uint32_t range = high-low;
+            return low + (long)(((uint64_t)next()*range)>>32);
+        }
+
+    private:
+        uint32_t m_state;
+};
+
+Random Random::Instance;
+
+}
+#endif
@@ -0,0 +1,122 @@
+#ifndef DR_WAVE_H
+#define DR_WAVE_H
+
+#include <math.h>
+#include <stdint.h>
+#include "./random.h"
+
+namespace DevRelief {
+
+// a phase is one cycle of a wave in 16 bits.  the top WAVE_TABLE_BITS index the tables
+#define WAVE_TABLE_BITS 8
+#define WAVE_TABLE_SIZE (1<<WAVE_TABLE_BITS)
+#define WAVE_STEP_BITS (16-WAVE_TABLE_BITS)
+// 1.0 in the sine table
+#define WAVE_SINE_ONE 32767
+// noise is the same for every run
+#define WAVE_NOISE_SEED 0x5eed
+// x is converted to an int32_t for the integer phase only inside this range
+#define WAVE_INT_LIMIT 2147483647.0
+
+// periodic waves and 1D value noise with values from 0 to 1.
+// tables are built the first time a wave is used
+class Wave {
+    public:
+        // the phase of x in a wave that repeats every period.
+        // whole numbers (e.g. sys(led) and a period in LEDs) are done in integers without a double divide.
+        // inf and NaN are phase 0
+        static uint16_t toPhase(double x, double period) {
+            if (!isfinite(x) || !isfinite(period)) {
+                return 0;
+            }
+            if (period <= 0) {
+                return 0;
+            }
+            if (period <= 0xFFFF && x > -WAVE_INT_LIMIT && x < WAVE_INT_LIMIT) {
+                int32_t wholeX = (int32_t)x;
+                uint32_t wholePeriod = (uint32_t)period;
+                if (wholeX == x && wholePeriod == period) {
+                    int32_t offset = wholeX % (int32_t)wholePeriod;
+                    if (offset < 0) {
+                        offset += wholePeriod;
+                    }
+                    return (uint16_t)(((uint32_t)offset << 16)/wholePeriod);
+                }
+            }
+            double cycles = x/period;
+            cycles -= floor(cycles);
+            // a tiny negative cycles rounds up to 1.0 which is phase 0
+            return (uint16_t)((uint32_t)(cycles*65536) & 0xFFFF);
+        }
+
+        // 0.5 at phase 0, 1 at a quarter cycle
+        static double sine(uint16_t phase) {
+            buildTables();
+            int index = phase >> WAVE_STEP_BITS;
+            int32_t fraction = phase & ((1<<WAVE_STEP_BITS)-1);
+            int32_t low = s_sine[index];
+            int32_t value = low + (((s_sine[index+1]-low)*fraction) >> WAVE_STEP_BITS);
+            return (value+WAVE_SINE_ONE)/(2.0*WAVE_SINE_ONE);
+        }
+
+        static double cosine(uint16_t phase) {
+            return sine(phase+16384);
+        }
+
+        // 0 at phase 0, 1 at half a cycle
+        static double triangle(uint16_t phase) {
+            uint32_t value = phase < 32768 ? phase*2 : (65536-phase)*2;
+            return value/65536.0;
+        }
+
+        // rises from 0 to 1 over a cycle
+        static double saw(uint16_t phase) {
+            return phase/65536.0;
+        }
+
+        // random values at whole numbers of cells, smoothly interpolated between them.
+        // repeats every WAVE_TABLE_SIZE cells.  inf and NaN are 0.5
+        static double noise(double cells) {
+            if (!isfinite(cells)) {
+                return 0.5;
+            }
+            buildTables();
+            // wrap into one table before converting so a huge cells fits an int.
+            // the table size is a power of 2 so this is exact
+            cells -= floor(cells/WAVE_TABLE_SIZE)*WAVE_TABLE_SIZE;
+            double start = floor(cells);
+            uint8_t cell = (uint8_t)(int)start;
+            int32_t t = (int32_t)((cells-start)*256);
+            // smoothstep 3t^2-2t^3 with t from 0 to 256
+            int32_t fade = (t*t*(3*256-2*t)) >> 16;
+            int32_t low = s_noise[cell];
+            int32_t value = low*256 + (s_noise[(uint8_t)(cell+1)]-low)*fade;
+            return value/(255.0*256);
+        }
+
+    private:
+        static void buildTables() {
+            if (s_built) {
+                return;
+            }
+            for(int i=0;i<=WAVE_TABLE_SIZE;i++) {
+                s_sine[i] = round(sin(2*M_PI*i/WAVE_TABLE_SIZE)*WAVE_SINE_ONE);
+            }
+            Random random(WAVE_NOISE_SEED);
+            for(int i=0;i<WAVE_TABLE_SIZE;i++) {
+                s_noise[i] = random.random(256);
+            }
+            s_built = true;
+        }
+
+        static bool s_built;
+        static int16_t s_sine[WAVE_TABLE_SIZE+1];
+        static uint8_t s_noise[WAVE_TABLE_SIZE];
+};
+
+bool Wave::s_built = false;
+int16_t Wave::s_sine[WAVE_TABLE_SIZE+1];
+uint8_t Wave::s_noise[WAVE_TABLE_SIZE];
+
+}
+#endif
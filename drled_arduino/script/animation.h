@@ -412,6 +412,7 @@ namespace DevRelief
         void destroy() { delete this;}
         virtual double calculate(double position) = 0;
         void update(IScriptContext* ctx) override { }
+        ValueVariance getVariance() const override { return VARIANCE_CONSTANT;}
 
     protected:
         DECLARE_LOGGER();
@@ -436,6 +437,16 @@ namespace DevRelief
 
     LinearEase DefaultEase;
     LinearEase* LinearEase::INSTANCE = &DefaultEase;
+    // eases with constant values are looked up in a table of EASE_TABLE_SIZE steps and interpolated between the two nearest values.
+    // the table is about 1KB.  it is allocated the first time the ease is calculated.
+    // eases with values that change each frame or LED calculate the curve instead of rebuilding the table
+    #define EASE_TABLE_BITS 8
+    #define EASE_TABLE_SIZE (1<<EASE_TABLE_BITS)
+    // fraction bits between two table entries
+    #define EASE_STEP_BITS 12
+    // fraction bits of table values
+    #define EASE_FIXED_BITS 16
+
     class CubicBezierEase : public AnimationEase
     {
     public:
@@ -444,6 +455,9 @@ namespace DevRelief
             m_out = out;
             m_inValue = NULL;
             m_outValue = NULL;
+            m_table = NULL;
+            m_tableValid = false;
+            m_perLED = false;
         }
 
         CubicBezierEase(IScriptValue* in, IScriptValue* out){
@@ -451,46 +465,81 @@ namespace DevRelief
             m_out = 1;
             m_inValue = in;
             m_outValue = out;
+            m_table = NULL;
+            m_tableValid = false;
+            m_perLED = getVariance() == VARIANCE_LED;
         }
 
         virtual ~CubicBezierEase() {
             if (m_inValue) { m_inValue->destroy();}
             if (m_outValue) { m_outValue->destroy();}
+            free(m_table);
         }
 
         void update(IScriptContext* ctx) override {
-            m_in = 1;
-            m_out = 1;
+            double in = 1;
+            double out = 1;
             if (m_inValue) {
-                m_in = (m_inValue->getFloatValue(ctx,1));
+                in = (m_inValue->getFloatValue(ctx,1));
             } 
             if (m_outValue) {
-                m_out = m_outValue->getFloatValue(ctx,0);
+                out = m_outValue->getFloatValue(ctx,0);
             }
+            setValues(in,out);
          }
 
+        ValueVariance getVariance() const override {
+            ValueVariance in = m_inValue ? m_inValue->getVariance() : VARIANCE_CONSTANT;
+            ValueVariance out = m_outValue ? m_outValue->getVariance() : VARIANCE_CONSTANT;
+            return in > out ? in : out;
+        }
+
         void setValues(IScriptValue* in, IScriptValue* out= NULL) {
             if (m_inValue) { m_inValue->destroy();}
             if (m_outValue) { m_outValue->destroy();}
             m_inValue = in;
             m_outValue = out;
+            m_perLED = getVariance() == VARIANCE_LED;
         }
 
         void setInValue(IScriptValue*in) {
             if (m_inValue) { m_inValue->destroy();}
             m_inValue = in;
+            m_perLED = getVariance() == VARIANCE_LED;
         }
 
         void setOutValue(IScriptValue*out) {
             if (m_outValue) { m_outValue->destroy();}
             m_outValue = out;
+            m_perLED = getVariance() == VARIANCE_LED;
         }
 
         void setValues(double in, double out) {
-            m_in = in;
-            m_out = out;
+            if (in != m_in || out != m_out) {
+                m_in = in;
+                m_out = out;
+                m_tableValid = false;
+            }
         }
+
         double calculate(double position)
+        {
+            if (position < 0 || position > 1 || !prepareTable()) {
+                return calculateFloat(position);
+            }
+            uint32_t fixed = position*(EASE_TABLE_SIZE<<EASE_STEP_BITS);
+            uint32_t index = fixed>>EASE_STEP_BITS;
+            if (index >= EASE_TABLE_SIZE) {
+                return (double)m_table[EASE_TABLE_SIZE]/(1<<EASE_FIXED_BITS);
+            }
+            int32_t low = m_table[index];
+            int32_t fraction = fixed&((1<<EASE_STEP_BITS)-1);
+            int32_t value = low + (((m_table[index+1]-low)*fraction)>>EASE_STEP_BITS);
+            return (double)value/(1<<EASE_FIXED_BITS);
+        }
+
+        // the curve the table is built from
+        double calculateFloat(double position)
         {
             double in = 1-m_in;
             double out = m_out;
@@ -499,6 +548,9 @@ namespace DevRelief
                             pow(position, 3);
             return val;
         }
+
+        // calculate() uses a table for the current values
+        bool hasTable() const { return m_tableValid;}
         
         bool toJson(JsonObject* json) const override {
             if (m_inValue) {
@@ -514,12 +566,38 @@ namespace DevRelief
             return true;
         }
     private:
+        // builds the table if it is out of date.  per-frame values rebuild it once in the first calculate() after they change.
+        // false if the table cannot be used
+        bool prepareTable() {
+            if (m_tableValid) {
+                return true;
+            }
+            if (m_perLED) {
+                return false;
+            }
+            if (m_table == NULL) {
+                m_table = (int32_t*)malloc(sizeof(int32_t)*(EASE_TABLE_SIZE+1));
+                if (m_table == NULL) {
+                    return false;
+                }
+            }
+            for(int i=0;i<=EASE_TABLE_SIZE;i++) {
+                m_table[i] = round(calculateFloat((double)i/EASE_TABLE_SIZE)*(1<<EASE_FIXED_BITS));
+            }
+            m_tableValid = true;
+            return true;
+        }
+
         double m_in;
         double m_out;
 
         IScriptValue* m_inValue;
         IScriptValue* m_outValue;
-        
+        // EASE_TABLE_SIZE+1 values.  NULL until an ease without per-LED values is calculated
+        int32_t* m_table;
+        bool m_tableValid;
+        // the in or out value changes for each LED so the curve is calculated without a table
+        bool m_perLED;
     };
 
 
@@ -552,6 +630,13 @@ namespace DevRelief
 
         RunState getState() { return m_domain->getState();}
         PositionUnit getUnit() const override { return m_range ? m_range->getUnit() : POS_UNSET;}
+
+        bool isPositionAnimation() const override {
+            if (m_domain == NULL || m_range == NULL || m_domain->isTime()) {
+                return false;
+            }
+            return m_ease == NULL || m_ease->getVariance() != VARIANCE_LED;
+        }
         double getRangeValue(IScriptContext* ctx)
         {
             if (m_domain == NULL || m_range==NULL) {
@@ -5,6 +5,7 @@
 #include "../lib/led/led_strip.h"
 #include "../config.h"
 #include "./script.h"
+#include "./frame_scheduler.h"
 
 namespace DevRelief {
 
@@ -16,11 +17,21 @@ namespace DevRelief {
                 SET_CUSTOM_LOGGER(m_periodicLogger,FiveSecondLogger);
                 m_script = NULL;
                 m_ledStrip = NULL;
+                m_rgbStrip = NULL;
+                m_compoundStrip = NULL;
+                m_rgbDirectEnabled = true;
+                m_rgbDirect = false;
+                m_brightness = -1;
+                m_randomSeed = 0;
+                m_stripPins = NULL;
+                m_outputFactory = &NeoPixelOutputFactory::Instance;
             }
 
             ~ScriptExecutor() { 
                 endScript();
+                delete m_rgbStrip;
                 delete m_ledStrip;
+                free(m_stripPins);
             }
 
             void turnOff() {
@@ -43,6 +54,8 @@ namespace DevRelief {
                     m_ledStrip->setLightness(i,level);
                     m_ledStrip->setHue(i,0);
                 }
+                // sent even if it matches the last frame so turnOff() always reaches the LEDs
+                m_ledStrip->resend();
                 m_ledStrip->show();
             }
 
@@ -62,6 +75,7 @@ namespace DevRelief {
                     m_ledStrip->setLightness(i,lightness);
                     m_ledStrip->setHue(i,hue);
                 }
+                m_ledStrip->resend();
                 m_ledStrip->show();
             }
 
@@ -70,19 +84,42 @@ namespace DevRelief {
                 m_logger->debug("setScript %x %x",m_ledStrip,m_script);
                 endScript();
                 m_script = script;
+                m_scheduler.reset();
+                // white() and solid() may have changed the strips' brightness
+                m_brightness = -1;
                 if (script != NULL) {
                     m_logger->debug("setScript %s, %x",script->getName(),m_ledStrip);
-                    script->begin(m_ledStrip,params);
+                    m_rgbDirect = m_rgbDirectEnabled && m_rgbStrip != NULL && script->isRGBDirect();
+                    script->setRandomSeed(m_randomSeed != 0 ? m_randomSeed : micros());
+                    if (m_rgbDirect) {
+                        script->begin(m_rgbStrip,params);
+                    } else {
+                        script->begin(m_ledStrip,params);
+                    }
                 }
             }
 
+            // scripts that only replace LEDs with RGB colors are drawn without the HSL frame unless this is disabled
+            void setRGBDirect(bool enabled) { m_rgbDirectEnabled = enabled;}
+            // the current script is drawn to the RGB strip
+            bool isRGBDirect() const { return m_rgbDirect;}
+
+            // scripts set after this use the same random values every run.  0 seeds each run from the clock
+            void setRandomSeed(uint32_t seed) { m_randomSeed = seed;}
+
             void endScript() {
                 if (m_script) {
                     m_script->destroy();
                     m_script = NULL;
                 }
+                if (m_rgbDirect) {
+                    // the RGB strip changed the pixels HSLStrip compares its frames to
+                    m_rgbDirect = false;
+                    m_ledStrip->invalidate();
+                }
             }
 
+            // the new strips always send their first frame
             void configChange(Config& config) {
                 turnOff();
                 setupLeds(config);
@@ -94,31 +131,65 @@ namespace DevRelief {
                     m_periodicLogger->info("\tnothing to run");
                     return;
                 }
+                if (!m_scheduler.isDue(millis(),m_script->getFrequency())) {
+                    return;
+                }
                 m_logger->never("\tm_script->setp()");
-                //m_ledStrip->clear();
+                m_scheduler.beginFrame();
                 int brightness = m_script->getBrightness();
                 setStripBrightness(brightness);
-                m_script->step();
-                //m_ledStrip->show();
+                if (m_script->step()) {
+                    m_scheduler.endFrame();
+                }
                 m_logger->never("\tfinished m_script->step()");
 
             }
+            // creates the outputs of strips made by later configChange() calls.  the factory is not owned
+            void setOutputFactory(ILedOutputFactory* factory) { m_outputFactory = factory;}
+
+            // time the last frame spent sending pixels to the LEDs
+            unsigned long getTransmitUsecs() { return m_compoundStrip ? m_compoundStrip->getTransmitUsecs() : 0;}
+            // physical strip frames sent and skipped because they did not change.  each strip counts its own frames
+            unsigned long getSentFrames() { return m_compoundStrip ? m_compoundStrip->getSentFrames() : 0;}
+            unsigned long getSkippedFrames() { return m_compoundStrip ? m_compoundStrip->getSkippedFrames() : 0;}
+
+            const FrameStats& getFrameStats() const { return m_scheduler.getStats();}
+            Script* getScript() { return m_script;}
+
+            // frame timing and the LEDs converted by the last frame
+            void getStats(JsonObject* json) {
+                m_scheduler.getStats().toJson(json);
+                json->setInt("frameMsecs",m_scheduler.getPeriodMsecs());
+                json->setString("mode",isRGBDirect() ? "rgb" : "hsl");
+                json->setInt("pixelsConverted",m_ledStrip && !isRGBDirect() ? m_ledStrip->getPixelsConverted() : 0);
+                json->setInt("drawUsecs",m_script ? (int)m_script->getDrawUsecs() : 0);
+                json->setInt("showUsecs",m_script ? (int)m_script->getShowUsecs() : 0);
+                json->setInt("transmitUsecs",(int)getTransmitUsecs());
+                json->setInt("sentFrames",(int)getSentFrames());
+                json->setInt("skippedFrames",(int)getSkippedFrames());
+                json->setString("script",m_script ? m_script->getName() : "");
+            }
+
         private:
+            // each physical strip rebuilds its brightness table when the brightness changes.  
+            // nothing is done on frames with the same brightness
             void setStripBrightness(int brightness){
-                if (m_compoundStrip == NULL) {return;}
-                const PtrList<LedPin*>& pins = Config::getInstance()->getPins();
-                for(int i=0;i<pins.size();i++){
-                    LedPin* pin = pins.get(i);
-                    if (pin != NULL && pin->maxBrightness>0) {
+                if (m_compoundStrip == NULL || m_stripPins == NULL || brightness == m_brightness) {return;}
+                // pixels already sent have the old brightness.  HSLStrip needs to resend all of them.
+                m_brightness = brightness;
+                m_ledStrip->invalidate();
+                m_ledStrip->resend();
+                // strips are found by the pin setupLeds() made them for.  not every pin has a strip
+                Config* config = Config::getInstance();
+                for(int stripNumber=0;stripNumber<m_compoundStrip->getStripCount();stripNumber++) {
+                    LedPin* pin = config->getPinNumber(m_stripPins[stripNumber]);
+                    DRLedStrip* strip = m_compoundStrip->getStripNumber(stripNumber);
+                    if (pin && strip && pin->maxBrightness>0) {
                         int bright = brightness < pin->maxBrightness ? brightness : pin->maxBrightness;
-                        DRLedStrip* strip = m_compoundStrip->getStripNumber(i);
-                        if (strip) {
-                            m_logger->debug("set strip bright %d",bright);
-                            strip->setBrightness(bright);
-                        }
+                        m_logger->debug("set strip bright %d",bright);
+                        strip->setBrightness(bright);
                     }
                 }
-                
             }
 
             void setupLeds(Config& config) {
@@ -126,21 +197,36 @@ namespace DevRelief {
                 if (m_ledStrip) {
                     delete m_ledStrip;
                 }
+                delete m_rgbStrip;
                 const PtrList<LedPin*>& pins = config.getPins();
                 int pixelPerMeter = pins.size()>0 ? pins[0]->pixelsPerMeter : 30;
                 CompoundLedStrip*  compound = new CompoundLedStrip(pixelPerMeter);
                 m_compoundStrip = compound;
+                free(m_stripPins);
+                m_stripPins = (int*)malloc(sizeof(int)*(pins.size() > 0 ? pins.size() : 1));
+                if (m_stripPins == NULL) {
+                    m_logger->error("out of memory for %d strip pins",pins.size());
+                }
                 int ledCount = 0;
                 pins.each([&](LedPin* pin) {
                     m_logger->debug("\tadd pin 0x%04X %d %d %d",pin,pin->number,pin->ledCount,pin->reverse);
                     if (pin->number >= 0) {
-                        DRLedStrip * real = new PhyisicalLedStrip(pin->number,pin->ledCount,pin->pixelsPerMeter,pin->pixelType,pin->maxBrightness);
+                        ILedOutput* output = m_outputFactory->create(pin->number,pin->ledCount,pin->pixelType);
+                        if (output == NULL) {
+                            m_logger->error("no output for pin %d",pin->number);
+                            return;
+                        }
+                        DRLedStrip * real = new PhyisicalLedStrip(output,pin->pixelsPerMeter,pin->maxBrightness,pin->gamma);
                         
                         if (pin->reverse) {
-                            auto* reverse = new ReverseStrip(real);
-                            compound->add(reverse);
+                            real = new ReverseStrip(real);
+                        }
+                        if (compound->add(real)) {
+                            if (m_stripPins) {
+                                m_stripPins[compound->getStripCount()-1] = pin->number;
+                            }
                         } else {
-                            compound->add(real);
+                            delete real;
                         }
 
 
@@ -148,6 +234,10 @@ namespace DevRelief {
                 });
 
                 m_ledStrip = new HSLStrip(compound);
+                m_ledStrip->allocateFrames();
+                // shares the compound strip owned by m_ledStrip
+                m_rgbStrip = new RGBStrip(compound);
+                m_brightness = -1;
                 m_logger->info("created HSLStrip");
             }
 
@@ -155,7 +245,16 @@ namespace DevRelief {
             DECLARE_CUSTOM_LOGGER(m_periodicLogger);
             Script* m_script;
             CompoundLedStrip * m_compoundStrip;
+            // the pin number of each strip in m_compoundStrip.  strip brightness is not set without it
+            int* m_stripPins;
             HSLStrip* m_ledStrip;
+            RGBStrip* m_rgbStrip;
+            bool m_rgbDirectEnabled;
+            bool m_rgbDirect;
+            int m_brightness;
+            uint32_t m_randomSeed;
+            ILedOutputFactory* m_outputFactory;
+            FrameScheduler m_scheduler;
     };
 
 }
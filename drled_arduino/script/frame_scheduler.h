@@ -0,0 +1,164 @@
+#ifndef DRFRAME_SCHEDULER_H
+#define DRFRAME_SCHEDULER_H
+
+#include "../lib/log/logger.h"
+#include "../lib/json/json.h"
+
+namespace DevRelief {
+
+// number of recent frame render times kept for the p99 calculation
+#define FRAME_TIME_SAMPLES 128
+
+// render times of drawn frames and counts of late and dropped frames
+class FrameStats {
+    public:
+        FrameStats() {
+            reset();
+        }
+
+        void reset() {
+            m_frames = 0;
+            m_lateFrames = 0;
+            m_droppedFrames = 0;
+            m_minUsecs = 0;
+            m_maxUsecs = 0;
+            m_totalUsecs = 0;
+            m_sampleCount = 0;
+            m_nextSample = 0;
+        }
+
+        void addFrame(unsigned long usecs, bool late) {
+            if (m_frames == 0 || usecs < m_minUsecs) { m_minUsecs = usecs;}
+            if (usecs > m_maxUsecs) { m_maxUsecs = usecs;}
+            m_frames++;
+            m_totalUsecs += usecs;
+            if (late) { m_lateFrames++;}
+            m_samples[m_nextSample] = usecs;
+            m_nextSample = (m_nextSample+1) % FRAME_TIME_SAMPLES;
+            if (m_sampleCount < FRAME_TIME_SAMPLES) { m_sampleCount++;}
+        }
+
+        void addDropped(int count) { m_droppedFrames += count;}
+
+        unsigned long getFrames() const { return m_frames;}
+        unsigned long getLateFrames() const { return m_lateFrames;}
+        unsigned long getDroppedFrames() const { return m_droppedFrames;}
+        unsigned long getMinUsecs() const { return m_minUsecs;}
+        unsigned long getMaxUsecs() const { return m_maxUsecs;}
+        unsigned long getAverageUsecs() const { return m_frames == 0 ? 0 : (unsigned long)(m_totalUsecs/m_frames);}
+
+        // 99th percentile of the recent frames.  only called for stats requests so a sorted copy is fine
+        unsigned long getP99Usecs() const {
+            if (m_sampleCount == 0) { return 0;}
+            uint32_t sorted[FRAME_TIME_SAMPLES];
+            for(int i=0;i<m_sampleCount;i++) {
+                uint32_t sample = m_samples[i];
+                int pos = i;
+                while(pos > 0 && sorted[pos-1] > sample) {
+                    sorted[pos] = sorted[pos-1];
+                    pos--;
+                }
+                sorted[pos] = sample;
+            }
+            int index = (m_sampleCount*99+99)/100-1;
+            return sorted[index];
+        }
+
+        void toJson(JsonObject* json) const {
+            json->setInt("frames",(int)m_frames);
+            json->setInt("lateFrames",(int)m_lateFrames);
+            json->setInt("droppedFrames",(int)m_droppedFrames);
+            json->setInt("minUsecs",(int)getMinUsecs());
+            json->setInt("avgUsecs",(int)getAverageUsecs());
+            json->setInt("maxUsecs",(int)getMaxUsecs());
+            json->setInt("p99Usecs",(int)getP99Usecs());
+        }
+
+    private:
+        unsigned long m_frames;
+        unsigned long m_lateFrames;
+        unsigned long m_droppedFrames;
+        unsigned long m_minUsecs;
+        unsigned long m_maxUsecs;
+        unsigned long long m_totalUsecs;
+        // 32 bits so frames over 65ms on long strips are not capped below maxUsecs
+        uint32_t m_samples[FRAME_TIME_SAMPLES];
+        int m_sampleCount;
+        int m_nextSample;
+};
+
+// decides when the next frame is due.  deadlines are a fixed period apart
+// from the first frame so render time does not add drift.
+// if one or more deadlines were missed they are dropped and the next frame draws now.
+class FrameScheduler {
+    public:
+        FrameScheduler() {
+            SET_LOGGER(ScriptExecutorLogger);
+            reset();
+        }
+
+        // the next isDue() starts a new timeline.  call when the script changes
+        void reset() {
+            m_started = false;
+            m_deadline = 0;
+            m_periodMsecs = 0;
+            m_frameStartUsecs = 0;
+            m_frameLate = false;
+            m_stats.reset();
+        }
+
+        // a period <= 0 draws on every call without deadlines
+        bool isDue(unsigned long nowMsecs, int periodMsecs) {
+            if (periodMsecs <= 0) {
+                m_started = false;
+                m_periodMsecs = 0;
+                m_frameLate = false;
+                return true;
+            }
+            if (!m_started || periodMsecs != m_periodMsecs) {
+                // first frame or the script changed its frequency
+                m_started = true;
+                m_periodMsecs = periodMsecs;
+                m_deadline = nowMsecs;
+            }
+            long early = (long)(m_deadline - nowMsecs);
+            if (early > 0) {
+                return false;
+            }
+            unsigned long lateMsecs = nowMsecs - m_deadline;
+            unsigned long missed = lateMsecs / m_periodMsecs;
+            if (missed > 0) {
+                m_logger->debug("dropped %d frames",missed);
+                m_stats.addDropped(missed);
+            }
+            m_frameLate = missed > 0;
+            m_deadline += (missed+1)*m_periodMsecs;
+            return true;
+        }
+
+        void beginFrame() {
+            m_frameStartUsecs = micros();
+        }
+
+        // a frame is late if it started a full period after its deadline or took longer than a period to draw
+        void endFrame() {
+            unsigned long usecs = micros()-m_frameStartUsecs;
+            bool late = m_frameLate || (m_periodMsecs > 0 && usecs > (unsigned long)m_periodMsecs*1000);
+            m_stats.addFrame(usecs,late);
+        }
+
+        const FrameStats& getStats() const { return m_stats;}
+        int getPeriodMsecs() const { return m_periodMsecs;}
+
+    private:
+        DECLARE_LOGGER();
+        bool m_started;
+        unsigned long m_deadline;
+        int m_periodMsecs;
+        unsigned long m_frameStartUsecs;
+        bool m_frameLate;
+        FrameStats m_stats;
+};
+
+}
+#endif
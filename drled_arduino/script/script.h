@@ -27,6 +27,8 @@ namespace DevRelief
             m_brightness=NULL;
             m_frequency=NULL;
             m_startMsecs = 0;
+            m_drawUsecs = 0;
+            m_showUsecs = 0;
             m_rootContainer = NULL;
         }
 
@@ -59,30 +61,47 @@ namespace DevRelief
             m_logger->debug("created RootContext");
         }
 
-        void step() {
-            auto lastStep = m_rootContainer->getContext()->getLastStep();
+        // rand(), randOf() and makers give the same values for the same seed
+        void setRandomSeed(uint32_t seed) {
+            getRootContainer()->getContext()->getRandom()->setSeed(seed);
+        }
+
+        // draws one frame.  the caller decides when a frame is due (see FrameScheduler).
+        // returns false if the script is past its duration
+        bool step() {
             int durationMsecs = getDuration();
             if (durationMsecs > 0 && (m_startMsecs>0 && m_startMsecs+durationMsecs<millis())) {
-                return; // past duration
-            }
-            int frequencyMsecs = getFrequency();
-            if (lastStep && frequencyMsecs>0 && lastStep->getStartMsecs() + frequencyMsecs > millis()) {
-                m_logger->test("too soon %d %d %d",lastStep?lastStep->getStartMsecs():-1, frequencyMsecs , millis());
-                return; // to soon to start next step
+                return false; // past duration
             }
-            m_logger->never("step %d %d %d",lastStep?lastStep->getStartMsecs():-1, frequencyMsecs , millis());
+            m_logger->never("step %d",millis());
             
+            unsigned long drawStart = micros();
             m_realStrip->clear();
 
             m_logger->debug("\tdraw");
             m_rootContainer->draw();
             m_logger->debug("\tend step");
 
+            unsigned long showStart = micros();
             m_realStrip->show();
             m_logger->debug("\tstep done");
+            m_drawUsecs = showStart-drawStart;
+            m_showUsecs = micros()-showStart;
+            return true;
+        }
 
+        // true if every LED the script draws is an RGB color that replaces the LED.
+        // these scripts can be drawn to an RGBStrip instead of converting an HSL frame in show()
+        bool isRGBDirect() {
+            ScriptRootContainer* root = getRootContainer();
+            HSLOperation op = root->getPosition()->getHSLOperation();
+            return op == REPLACE && root->isRGBDirect(op);
         }
 
+        // time spent in the last step()
+        unsigned long getDrawUsecs() const { return m_drawUsecs;}
+        unsigned long getShowUsecs() const { return m_showUsecs;}
+
         void setName(const char * name) { m_name = name; }
         const char * getName() { return m_name;}
 
@@ -136,6 +155,8 @@ namespace DevRelief
         IScriptValue* m_brightness;
         IScriptValue*  m_frequency;
         int m_startMsecs;
+        unsigned long m_drawUsecs;
+        unsigned long m_showUsecs;
     };
 
    
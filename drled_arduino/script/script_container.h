@@ -41,6 +41,15 @@ namespace DevRelief
 
         const PtrList<IScriptElement*>& getChildren() const override { return m_children;}
 
+        bool isRGBDirect(HSLOperation rootOp) const override {
+            for(int i=0;i<m_children.size();i++) {
+                if (!m_children.get(i)->isRGBDirect(rootOp)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
         void draw(IScriptContext* parentContext) override {
             m_logger->debug("draw %x %s  parent: %x",this,getType(),parentContext);
             m_context->setStrip(m_strip);
@@ -430,7 +439,7 @@ namespace DevRelief
                 long time = parentContext->getStep()->getMsecsSincePrev();
                 if (chance != 0) {
                     double shouldPercent = 100*chance*time/1000.0;
-                    int r = random(100);
+                    int r = parentContext->getRandom()->random(100);
                     if (r < shouldPercent) { 
                         return true;
                     }
@@ -66,14 +66,16 @@ namespace DevRelief
     class ScriptContext: public IScriptContext
     {
         public:
-            ScriptContext(const char * type, IScriptContext* parent) { 
+            // names is the RootContext's table.  other contexts use their parent's
+            ScriptContext(const char * type, IScriptContext* parent, ScriptNames* names=NULL) { 
                 m_type = type;
                 SET_LOGGER(ScriptLogger);
                 m_strip = NULL;
                 m_position = NULL;
                 m_parentContext = parent;
+                m_names = names ? names : (parent ? parent->getNames() : NULL);
                 m_startTimeMsecs = millis();
-                m_valueList = new ScriptValueList();
+                m_valueList = new ScriptValueList(m_names);
             }
 
             virtual ~ScriptContext() {
@@ -116,25 +118,31 @@ namespace DevRelief
             }
 
             IScriptValue* getValue(const char * name)override  {
-                if (m_valueList == NULL) { return NULL; }
-                IScriptValue* val = m_valueList->getValue(name);
+                return getValueById(m_names ? m_names->findId(name) : -1);
+            };
+
+            void setValueById(int nameId, IScriptValue* value) override  {
+                m_valueList->setValueById(nameId,value);
+            }
+
+            IScriptValue* getValueById(int nameId) override  {
+                if (m_valueList == NULL || nameId < 0) { return NULL; }
+                IScriptValue* val = m_valueList->getValueById(nameId);
                 if (val == NULL && m_parentContext != NULL) {
-                    val = m_parentContext->getValue(name);
+                    val = m_parentContext->getValueById(nameId);
                 }
                 return val;
             };
 
             IScriptValue* getSysValue(const char * name)override  {
-                if (m_valueList == NULL) { return NULL; }
-                DRFormattedString fullName("sys:%s",name);
-                return getValue(fullName.text());
-                //return m_valueList->getValue(fullName);
+                return getValueById(m_names ? m_names->getSysId(name) : -1);
             };
 
             void setSysValue(const char * name, IScriptValue* value)  {
-                DRFormattedString fullName("sys:%s",name);
-                m_valueList->setValue(fullName,value);
+                setValueById(m_names ? m_names->getSysId(name) : -1,value);
             }
+
+            ScriptNames* getNames() override { return m_names;}
             
 
             IScriptElement* getCurrentElement() const override { return m_currentElement;}
@@ -163,14 +171,23 @@ namespace DevRelief
             DECLARE_LOGGER();    
 
             IScriptElement* m_currentElement; 
+            ScriptNames* m_names;
             IScriptValueProvider * m_valueList;
             PositionDomain m_positionDomain;
             IElementPosition* m_position;
     };
 
-    class RootContext : public ScriptContext {
+    // holds a RootContext's names.  it is a base listed before ScriptContext so the names
+    // are constructed before the context's value list and destroyed after it
+    class RootNames {
+        protected:
+            // names used by this run of the script.  freed with the context
+            ScriptNames m_scriptNames;
+    };
+
+    class RootContext : private RootNames, public ScriptContext {
         public:
-        RootContext( ) : ScriptContext("RootContext",NULL)
+        RootContext( ) : RootNames(), ScriptContext("RootContext",NULL,&m_scriptNames)
         {
             
         }
@@ -205,6 +222,8 @@ namespace DevRelief
             return &m_lastStep;
         };
 
+        Random* getRandom() override { return &m_random;}
+
         IScriptStep* beginStep()  {
             m_currentStep.begin(&m_lastStep);
             return &m_currentStep;
@@ -231,6 +250,7 @@ namespace DevRelief
             }
             ScriptStep  m_currentStep;
             ScriptStep  m_lastStep;
+            Random m_random;
     };
 
     class ChildContext : public ScriptContext {
@@ -249,6 +269,10 @@ namespace DevRelief
                 return m_parentContext ? m_parentContext->getLastStep() : NULL;
             };
 
+            Random* getRandom() override {
+                return m_parentContext ? m_parentContext->getRandom() : &Random::Instance;
+            }
+
         protected:
 
     };
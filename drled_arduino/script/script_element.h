@@ -86,6 +86,10 @@ namespace DevRelief {
             }
 
             ScriptStatus getStatus() const override { return m_status;}
+
+            // elements draw HSL values unless they say they only replace LEDs with RGB colors.
+            // containers and elements that do not draw LEDs return true
+            bool isRGBDirect(HSLOperation rootOp) const override { return false;}
         protected:
             virtual void valuesToJson(JsonObject* json) const{
                 m_logger->never("ScriptElement type %s does not implement valuesToJson",getType());
@@ -209,9 +213,12 @@ namespace DevRelief {
                 m_values.setValue(name,val);
             }
 
+            // values do not draw LEDs so they work with any strip
+            bool isRGBDirect(HSLOperation rootOp) const override { return true;}
+
             virtual void draw(IScriptContext*context) override {
                 m_values.each([&](NameValue*nameValue){
-                    context->setValue(nameValue->getName(),new ScriptValueReference(nameValue->getValue()));
+                    context->setValueById(nameValue->getId(context->getNames()),new ScriptValueReference(nameValue->getValue()));
                 });
             }
 
@@ -234,6 +241,30 @@ namespace DevRelief {
             ScriptValueList m_values;
     };
 
+    // caches the value of an IScriptValue that doesn't change per LED.
+    // update() is called once per draw() and getIntValue() for each LED
+    class FrameValue {
+        public:
+            FrameValue() {
+                m_isCached = false;
+                m_value = 0;
+            }
+
+            void update(IScriptValue* value, IScriptContext* ctx, int defaultValue) {
+                m_isCached = value != NULL && value->getVariance() != VARIANCE_LED;
+                if (m_isCached) {
+                    m_value = value->getIntValue(ctx,defaultValue);
+                }
+            }
+
+            int getIntValue(IScriptValue* value, IScriptContext* ctx, int defaultValue) {
+                return m_isCached ? m_value : value->getIntValue(ctx,defaultValue);
+            }
+        private:
+            bool m_isCached;
+            int m_value;
+    };
+
     class ScriptLEDElement : public PositionableElement{
         public:
             ScriptLEDElement(const char* type) : PositionableElement(type,&m_elementPosition) {
@@ -251,6 +282,7 @@ namespace DevRelief {
                 //m_elementPosition.evaluateValues(context);
                 m_logger->never("create DrawStrip");
                 DrawStrip strip(context,parentStrip,&m_elementPosition);
+                updateFrameValues(context);
                 m_logger->never("\titerate LEDs");
                 strip.eachLED([&](IHSLStripLED& led) {
                     DrawLED* dl = (DrawLED*)&led;
@@ -263,7 +295,6 @@ namespace DevRelief {
 
             }
 
-
             void valuesToJson(JsonObject* json) const override {
                 PositionableElement::valuesToJson(json);
             }
@@ -273,7 +304,8 @@ namespace DevRelief {
             }
 
         protected:
-            
+            // evaluate values that are the same for every LED in this step
+            virtual void updateFrameValues(IScriptContext* context) {}
             virtual void drawLED(IHSLStripLED& led)=0;
             ScriptElementPosition m_elementPosition;
             
@@ -306,9 +338,15 @@ namespace DevRelief {
                 m_lightness = val;
             }
         protected:
+            void updateFrameValues(IScriptContext* context) override {
+                m_frameHue.update(m_hue,context,-1);
+                m_frameLightness.update(m_lightness,context,-1);
+                m_frameSaturation.update(m_saturation,context,-1);
+            }
+
             void drawLED(IHSLStripLED& led) override {
                 if (m_hue) {
-                    int hue = m_hue->getIntValue(led.getContext(),-1);
+                    int hue = m_frameHue.getIntValue(m_hue,led.getContext(),-1);
                     if (hue != -1) {
                         m_logger->debug("drawLED hue %d %d",led.getIndex(),hue);
                         led.setHue(adjustHue(hue));
@@ -316,14 +354,14 @@ namespace DevRelief {
                 }
                 
                 if (m_lightness) {
-                    int lightness = m_lightness->getIntValue(led.getContext(),-1);
+                    int lightness = m_frameLightness.getIntValue(m_lightness,led.getContext(),-1);
                     if (lightness != -1) {
                         m_logger->debug("set lightness %d - %d",led.getIndex(),lightness);
                         led.setLightness(adjustLightness( lightness));
                     }
                 }
                 if (m_saturation) {
-                    int saturation = m_saturation->getIntValue(led.getContext(),-1);
+                    int saturation = m_frameSaturation.getIntValue(m_saturation,led.getContext(),-1);
                     if (saturation != -1) {
                         led.setSaturation(adjustSaturation( saturation));
                     }
@@ -360,6 +398,9 @@ namespace DevRelief {
             IScriptValue* m_hue;
             IScriptValue* m_saturation;
             IScriptValue* m_lightness;
+            FrameValue m_frameHue;
+            FrameValue m_frameSaturation;
+            FrameValue m_frameLightness;
     };
 
     class RainbowHSLElement : public HSLElement {
@@ -387,6 +428,7 @@ namespace DevRelief {
             }
 
         private:
+            // allocates a 1KB ease table the first time a hue is drawn
             CubicBezierEase m_map;
 
     };
@@ -417,20 +459,34 @@ namespace DevRelief {
                 if (m_blue) { m_blue->destroy();}
                 m_blue = val;
             }
+
+            bool isRGBDirect(HSLOperation rootOp) const override {
+                HSLOperation op = m_elementPosition.getHSLOperation();
+                if (op == INHERIT || op == UNSET) {
+                    op = rootOp;
+                }
+                return op == REPLACE;
+            }
         protected:
+            void updateFrameValues(IScriptContext* context) override {
+                m_frameRed.update(m_red,context,0);
+                m_frameGreen.update(m_green,context,0);
+                m_frameBlue.update(m_blue,context,0);
+            }
+
             void drawLED(IHSLStripLED& led) override {
                 int red = 0;
                 int green = 0;
                 int blue = 0;
                 if (m_red) {
-                    red = m_red->getIntValue(led.getContext(),0);
+                    red = m_frameRed.getIntValue(m_red,led.getContext(),0);
                 }
                 
                 if (m_blue) {
-                    blue = m_blue->getIntValue(led.getContext(),0);
+                    blue = m_frameBlue.getIntValue(m_blue,led.getContext(),0);
                 }
                 if (m_green) {
-                    green = m_green->getIntValue(led.getContext(),0);
+                    green = m_frameGreen.getIntValue(m_green,led.getContext(),0);
                 }
                 if (red != 0 || blue != 0 || green != 0) {
                     CRGB rgb(red,green,blue);
@@ -466,6 +522,9 @@ namespace DevRelief {
             IScriptValue* m_red;
             IScriptValue* m_green;
             IScriptValue* m_blue;
+            FrameValue m_frameRed;
+            FrameValue m_frameGreen;
+            FrameValue m_frameBlue;
     };
 
 }
@@ -73,6 +73,29 @@ namespace DevRelief{
                 
                 m_parent->setRGB(rgb,translateIndex(index),translateOp(op));
             }  
+
+            // the span is translated once.  if any LED in it wraps or clips, each LED is translated individually.
+            void setSpan(HSLChannel channel, int index, int count, int step, const int16_t* values, HSLOperation op) override {
+                if (count <= 0) { return;}
+                int last = index+(count-1)*step;
+                if (!isPositionValid(index) || !isPositionValid(last) || !isLinearSpan(index,last)) {
+                    setEachInSpan(channel,index,count,step,values,op);
+                    return;
+                }
+                setParentSpan(channel,translateIndex(index),count,m_reverse ? -step : step,values,translateOp(op));
+            }
+
+            void setEachInSpan(HSLChannel channel, int index, int count, int step, const int16_t* values, HSLOperation op) {
+                for(int i=0;i<count;i++,index+=step) {
+                    int16_t value = values[i];
+                    if (value == HSL_SPAN_SKIP) { continue;}
+                    switch(channel) {
+                        case HSL_HUE: setHue(value,index,op); break;
+                        case HSL_SATURATION: setSaturation(value,index,op); break;
+                        case HSL_LIGHTNESS: setLightness(value,index,op); break;
+                    }
+                }
+            }
   
             int getFlowIndex() const { 
                 return m_flowIndex;
@@ -227,6 +250,57 @@ namespace DevRelief{
                 return m_parent->getLength();
             }
 
+            virtual void setParentSpan(HSLChannel channel, int index, int count, int step, const int16_t* values, HSLOperation op) {
+                m_parent->setSpan(channel,index,count,step,values,op);
+            }
+
+            // this strip's translateIndex() composed with the parent's transform.
+            // only indexes translateIndex() does not wrap or clip are included
+            void getTransform(StripTransform& transform) override {
+                if (m_parent == NULL) {
+                    transform.low = 1;
+                    transform.high = 0;
+                    return;
+                }
+                StripTransform parent;
+                m_parent->getTransform(parent);
+                composeTransform(transform,parent);
+            }
+
+            void composeTransform(StripTransform& transform, const StripTransform& parent) {
+                int scale = m_reverse ? -1 : 1;
+                int first = m_reverse ? m_offset+m_length-1 : m_offset;   // offset before m_relativeOffset
+                int low = -STRIP_INDEX_LIMIT;
+                int high = STRIP_INDEX_LIMIT;
+                if (m_overflow == OVERFLOW_WRAP) {
+                    low = 0;
+                    high = m_length-1;
+                } else if (m_overflow == OVERFLOW_CLIP) {
+                    low = m_offset;
+                    high = m_offset+m_length-1;
+                }
+                int indexLow = scale > 0 ? low-first : first-high;
+                int indexHigh = scale > 0 ? high-first : first-low;
+                transform.compose(scale,first+m_relativeOffset,indexLow,indexHigh,parent);
+                if (m_overflow == OVERFLOW_WRAP && !m_reverse && transform.low == indexLow && transform.high == indexHigh) {
+                    transform.period = m_length;
+                }
+            }
+
+            // true if translateIndex() does not wrap or clip any index from first to last
+            bool isLinearSpan(int first, int last) {
+                int start = m_offset + (m_reverse ? (m_length-first-1) : first);
+                int end = m_offset + (m_reverse ? (m_length-last-1) : last);
+                int low = start < end ? start : end;
+                int high = start < end ? end : start;
+                if (m_overflow == OVERFLOW_WRAP) {
+                    return low >= 0 && high < m_length;
+                } else if (m_overflow == OVERFLOW_CLIP) {
+                    return low >= m_offset && high < m_offset+m_length;
+                }
+                return true;
+            }
+
             IScriptHSLStrip* m_parent;
             IElementPosition* m_position;
             int m_parentLength;
@@ -326,8 +400,26 @@ namespace DevRelief{
             void setRGB(const CRGB& rgb,int index, HSLOperation op) override {
                 
                 m_base->setRGB(translateIndex(index),rgb,translateOp(op));
+            }
+
+            void setParentSpan(HSLChannel channel, int index, int count, int step, const int16_t* values, HSLOperation op) override {
+                m_base->setSpan(channel,index,count,step,values,op);
             }  
 
+            void getTransform(StripTransform& transform) override {
+                StripTransform base;
+                if (m_base == NULL) {
+                    transform.low = 1;
+                    transform.high = 0;
+                    return;
+                }
+                base.low = 0;
+                base.high = m_base->getCount()-1;
+                base.base = m_base;
+                base.inheritOp = m_position ? m_position->getHSLOperation() : ADD;
+                composeTransform(transform,base);
+            }
+
             void setHSLStrip(IHSLStrip* base) {
                 m_base = base;
                 m_length = base ? base->getCount() : 0;
@@ -366,12 +458,16 @@ namespace DevRelief{
 
     };
 
+    // number of LEDs DrawStrip buffers before writing them to the strip as spans
+    #define DRAW_SPAN_LENGTH 32
+
     class DrawLED : public IHSLStripLED {
         public:
             DrawLED(IScriptHSLStrip* strip, IScriptContext*context,HSLOperation op) {
                 m_strip = strip;
                 m_context = context;
                 m_operation = op;
+                m_spanIndex = 0;
                 SET_LOGGER(ScriptHSLStripLogger);
             }
 
@@ -379,18 +475,36 @@ namespace DevRelief{
                 m_index = p;
             }
 
+            // HSL values are buffered at spanIndex until flushSpan()
+            void setSpanIndex(int spanIndex) {
+                m_spanIndex = spanIndex;
+            }
+
             int index() { return m_index;}
 
+            void beginSpan() {
+                for(int i=0;i<DRAW_SPAN_LENGTH;i++) {
+                    m_hue[i] = HSL_SPAN_SKIP;
+                    m_saturation[i] = HSL_SPAN_SKIP;
+                    m_lightness[i] = HSL_SPAN_SKIP;
+                }
+            }
+
+            void flushSpan(int index, int count, int step) {
+                m_strip->setSpan(HSL_HUE,index,count,step,m_hue,m_operation);
+                m_strip->setSpan(HSL_LIGHTNESS,index,count,step,m_lightness,m_operation);
+                m_strip->setSpan(HSL_SATURATION,index,count,step,m_saturation,m_operation);
+            }
 
             void setHue(int hue) override {
                 m_logger->debug("Set hue %d %d",m_index,hue);
-                m_strip->setHue(hue,m_index,m_operation);
+                m_hue[m_spanIndex] = hue;
             }
             void setSaturation(int saturation) override {
-                m_strip->setSaturation(saturation,m_index,m_operation);
+                m_saturation[m_spanIndex] = saturation;
             }
             void setLightness(int lightness) override {
-                m_strip->setLightness(lightness,m_index,m_operation);
+                m_lightness[m_spanIndex] = lightness;
             }
             void setRGB(const CRGB& rgb)  override {
                 m_strip->setRGB(rgb,m_index,m_operation);
@@ -401,6 +515,10 @@ namespace DevRelief{
             virtual int getIndex()const {return m_index;}
         private:
             int m_index;
+            int m_spanIndex;
+            int16_t m_hue[DRAW_SPAN_LENGTH];
+            int16_t m_saturation[DRAW_SPAN_LENGTH];
+            int16_t m_lightness[DRAW_SPAN_LENGTH];
             HSLOperation m_operation;
             IScriptHSLStrip* m_strip;
             IScriptContext * m_context;
@@ -415,12 +533,68 @@ namespace DevRelief{
                 m_position = position;
                 m_position->evaluateValues(context);
                 updatePosition(position,context);
+                getTransform(m_transform);
+            }
+
+            // LEDs inside the composed transform are written to the target without walking the parents
+            void setHue(int16_t hue,int index, HSLOperation op) override {
+                if (!m_transform.contains(index)) {
+                    ScriptHSLStrip::setHue(hue,index,op);
+                } else if (m_transform.target) {
+                    m_transform.target->setHue(hue,m_transform.apply(index),op);
+                } else {
+                    m_transform.base->setHue(m_transform.apply(index),hue,m_transform.resolveOp(op));
+                }
+            }
+
+            void setSaturation(int16_t saturation,int index, HSLOperation op) override {
+                if (!m_transform.contains(index)) {
+                    ScriptHSLStrip::setSaturation(saturation,index,op);
+                } else if (m_transform.target) {
+                    m_transform.target->setSaturation(saturation,m_transform.apply(index),op);
+                } else {
+                    m_transform.base->setSaturation(m_transform.apply(index),saturation,m_transform.resolveOp(op));
+                }
+            }
+
+            void setLightness(int16_t lightness,int index, HSLOperation op) override {
+                if (!m_transform.contains(index)) {
+                    ScriptHSLStrip::setLightness(lightness,index,op);
+                } else if (m_transform.target) {
+                    m_transform.target->setLightness(lightness,m_transform.apply(index),op);
+                } else {
+                    m_transform.base->setLightness(m_transform.apply(index),lightness,m_transform.resolveOp(op));
+                }
+            }
+
+            void setRGB(const CRGB& rgb,int index, HSLOperation op) override {
+                if (!m_transform.contains(index)) {
+                    ScriptHSLStrip::setRGB(rgb,index,op);
+                } else if (m_transform.target) {
+                    m_transform.target->setRGB(rgb,m_transform.apply(index),op);
+                } else {
+                    m_transform.base->setRGB(m_transform.apply(index),rgb,m_transform.resolveOp(op));
+                }
+            }
+
+            void setSpan(HSLChannel channel, int index, int count, int step, const int16_t* values, HSLOperation op) override {
+                if (count <= 0) { return;}
+                int last = index+(count-1)*step;
+                if (!m_transform.contains(index) || !m_transform.contains(last)) {
+                    ScriptHSLStrip::setSpan(channel,index,count,step,values,op);
+                } else if (m_transform.target) {
+                    m_transform.target->setSpan(channel,m_transform.apply(index),count,step*m_transform.scale,values,op);
+                } else {
+                    m_transform.base->setSpan(channel,m_transform.apply(index),count,step*m_transform.scale,values,m_transform.resolveOp(op));
+                }
             }
 
             virtual ~DrawStrip() {
 
             }
 
+            // the drawer is called for each LED.  HSL values are collected in the DrawLED
+            // and written to the strip DRAW_SPAN_LENGTH LEDs at a time
             void eachLED(auto&& drawer) {
                 
                 HSLOperation op = m_position->getHSLOperation();
@@ -434,10 +608,16 @@ namespace DevRelief{
                 int count = abs(m_length);
                 int neg = m_length<0?-1 : 1;
                 m_logger->debug("drawStrip %d",count);
-                for(int i=0;i<count;i++){
-                    if (domain) {domain->setPos(i);}
-                    led.setIndex(i*neg);
-                    drawer(led);
+                for(int start=0;start<count;start+=DRAW_SPAN_LENGTH){
+                    int spanLength = count-start < DRAW_SPAN_LENGTH ? count-start : DRAW_SPAN_LENGTH;
+                    led.beginSpan();
+                    for(int i=0;i<spanLength;i++){
+                        if (domain) {domain->setPos(start+i);}
+                        led.setIndex((start+i)*neg);
+                        led.setSpanIndex(i);
+                        drawer(led);
+                    }
+                    led.flushSpan(start*neg,spanLength,neg);
                 }
             }
 
@@ -452,6 +632,7 @@ namespace DevRelief{
         private:
             IScriptContext* m_context;
             IElementPosition*m_position;
+            StripTransform m_transform;
 
 
     };
@@ -3,6 +3,7 @@
 
 #include "../lib/led/led_strip.h"
 #include "../lib/json/json_interface.h"
+#include "../lib/util/random.h"
 
 namespace DevRelief{
     typedef enum PositionUnit
@@ -36,12 +37,21 @@ namespace DevRelief{
         STATE_COMPLETE
     };
 
+    // how often an IScriptValue can change.  determined when the script is loaded.
+    // constant and per-frame values only need to be evaluated once per step, not for every LED
+    typedef enum ValueVariance {
+        VARIANCE_CONSTANT=0,
+        VARIANCE_FRAME=1,
+        VARIANCE_LED=2
+    } ValueVariance;
+
     class IScriptContext;
     class IScriptValue;
     class IScriptHSLStrip;
     class IScriptElement;
     class PositionDomain;
     class ScriptValueList;
+    class ScriptNames;
     class ScriptContainer;
     class ScriptTimerValue;
 
@@ -139,6 +149,7 @@ namespace DevRelief{
             virtual void destroy()=0;
             virtual double calculate(double position) = 0;
             virtual void update(IScriptContext* ctx)=0;
+            virtual ValueVariance getVariance() const=0;
             virtual bool toJson(JsonObject* json) const=0;
     };
 
@@ -150,6 +161,8 @@ namespace DevRelief{
         virtual void update(IScriptContext* ctx)=0;
         virtual bool toJson(JsonObject* json) const=0;
         virtual PositionUnit getUnit() const=0;
+        // true if the range value only changes with the position domain during a step
+        virtual bool isPositionAnimation() const=0;
     };
 
     class IHSLStripLED {
@@ -165,9 +178,64 @@ namespace DevRelief{
     };
     
     
+    // far outside any strip.  small enough that index arithmetic cannot overflow
+    const int STRIP_INDEX_LIMIT = 0x10000000;
+
+    // a strip's index mapped through its parents in one step.  an index i in [low,high]
+    // becomes i*scale+shift.  that is an index of target or, if target is NULL, of the root's IHSLStrip
+    class StripTransform {
+        public:
+            StripTransform() {
+                scale = 1;
+                shift = 0;
+                low = -STRIP_INDEX_LIMIT;
+                high = STRIP_INDEX_LIMIT;
+                target = NULL;
+                base = NULL;
+                inheritOp = REPLACE;
+                period = 0;
+            }
+
+            bool contains(int index) const { return index >= low && index <= high;}
+            int apply(int index) const { return index*scale+shift;}
+            HSLOperation resolveOp(HSLOperation op) const { return (op == INHERIT || op == UNSET) ? inheritOp : op;}
+
+            // index moved back into [low,high] if the strip wraps indexes past high
+            int wrap(int index) const {
+                if (period <= 0 || index <= high) { return index;}
+                return low+(index-low)%period;
+            }
+
+            // this = parent(own(i)).  own maps i to the parent's index with scale ±1
+            void compose(int ownScale, int ownShift, int ownLow, int ownHigh, const StripTransform& parent) {
+                // indexes that stay within the parent's range
+                int parentLow = ownScale > 0 ? parent.low-ownShift : ownShift-parent.high;
+                int parentHigh = ownScale > 0 ? parent.high-ownShift : ownShift-parent.low;
+                low = ownLow > parentLow ? ownLow : parentLow;
+                high = ownHigh < parentHigh ? ownHigh : parentHigh;
+                scale = parent.scale*ownScale;
+                shift = parent.scale*ownShift+parent.shift;
+                target = parent.target;
+                base = parent.base;
+                inheritOp = parent.inheritOp;
+                period = 0;
+            }
+
+            int scale;
+            int shift;
+            int low;
+            int high;
+            IScriptHSLStrip* target;
+            IHSLStrip* base;
+            // the op used by the root for INHERIT and UNSET
+            HSLOperation inheritOp;
+            // if not 0, index i past high is the same LED as i-period
+            int period;
+    };
+
     class IScriptHSLStrip {
         public:
-            virtual void destroy();
+            virtual void destroy()=0;
             virtual int getOffset()=0;
             virtual int getLength()=0;
 
@@ -179,6 +247,8 @@ namespace DevRelief{
             virtual void setSaturation(int16_t saturation, int index, HSLOperation op)=0;
             virtual void setLightness(int16_t lightness, int index, HSLOperation op)=0;
             virtual void setRGB(const CRGB& rgb, int index, HSLOperation op)=0;
+            // write values[i] to index+i*step.  HSL_SPAN_SKIP values are not written
+            virtual void setSpan(HSLChannel channel, int index, int count, int step, const int16_t* values, HSLOperation op)=0;
 
             virtual void updatePosition(IElementPosition * pos, IScriptContext* context)=0;
 
@@ -188,7 +258,11 @@ namespace DevRelief{
             virtual int getFlowIndex() const=0;
             virtual void setFlowIndex(int index)=0;
 
-            virtual int getPixelsPerMeter(int strip=-1);
+            // the transform from this strip's indexes to the first strip that cannot be composed (e.g. MirrorStrip) 
+            // or the root's IHSLStrip.  valid until the next updatePosition() of this strip or a parent
+            virtual void getTransform(StripTransform& transform)=0;
+
+            virtual int getPixelsPerMeter(int strip=-1)=0;
 
     };
 
@@ -198,6 +272,8 @@ namespace DevRelief{
 
             virtual IScriptStep* getStep()=0;
             virtual IScriptStep* getLastStep()=0;
+            // one generator for each script run (see Script::setRandomSeed)
+            virtual Random* getRandom()=0;
 
             virtual PositionDomain* getAnimationPositionDomain()=0;
 
@@ -205,6 +281,11 @@ namespace DevRelief{
             virtual void setSysValue(const char * name, IScriptValue* value)=0;
             virtual IScriptValue* getValue(const char * name)=0;
             virtual IScriptValue* getSysValue(const char * name)=0;
+            // ids come from getNames().  they avoid string compares for values used every LED
+            virtual void setValueById(int nameId, IScriptValue* value)=0;
+            virtual IScriptValue* getValueById(int nameId)=0;
+            // the RootContext's names.  each script run has its own ids
+            virtual ScriptNames* getNames()=0;
 
             virtual void setStrip(IScriptHSLStrip*strip)=0;
             virtual IScriptHSLStrip* getStrip() const = 0;
@@ -253,6 +334,8 @@ namespace DevRelief{
 
         virtual bool isRecursing()const = 0; // mainly for evaluating variable values
 
+        virtual ValueVariance getVariance() const = 0;
+
         // used to generate JSON text to save or return to value
         virtual IJsonElement* toJson(JsonRoot* jsonRoot)=0;
         
@@ -277,6 +360,8 @@ namespace DevRelief{
         virtual bool hasValue(const char *name) = 0;
         virtual IScriptValue *getValue(const char *name) = 0;
         virtual void setValue(const char *name, IScriptValue*val)=0;
+        virtual IScriptValue *getValueById(int nameId) = 0;
+        virtual void setValueById(int nameId, IScriptValue*val)=0;
         virtual void initialize(ScriptValueList* source, IScriptContext* context)=0;
         virtual void clear()=0;
     };
@@ -298,6 +383,8 @@ namespace DevRelief{
             virtual void updatePosition(IElementPosition* parentPosition, IScriptContext* parentContext)=0;
             virtual ScriptStatus updateStatus(IScriptContext* context)=0;
             virtual ScriptStatus getStatus() const =0;
+            // true if the element only draws RGB colors that replace LEDs.  rootOp is used for INHERIT
+            virtual bool isRGBDirect(HSLOperation rootOp) const =0;
     };
 
     class IScriptContainer {
@@ -340,6 +427,7 @@ namespace DevRelief{
 
         int getPixelCount() const { return m_pixelCount;}
         IScriptValue* getValue() const { return m_value;}
+        IScriptValue* getRepeatCount() const { return m_repeatCount;}
         PositionUnit getUnit() const { return m_unit;}
         virtual void destroy() { delete this;}
 
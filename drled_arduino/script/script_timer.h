@@ -96,7 +96,7 @@ namespace DevRelief
             void evaluate(IScriptContext* context, ScriptValueList& list) {
                 list.each([&](NameValue* value) {
                     double val = value->getValue()->getFloatValue(context,0);
-                    context->setValue(value->getName(),new ScriptNumberValue(val));
+                    context->setValueById(value->getId(context->getNames()),new ScriptNumberValue(val));
                 });
             }
             ScriptStatus m_status;
@@ -237,6 +237,7 @@ namespace DevRelief
             IScriptValue* eval(IScriptContext * ctx, double defaultValue) override { return new ScriptTimerValue(this);}
 
             bool isRecursing() const override { return false;}
+            ValueVariance getVariance() const override { return VARIANCE_FRAME;}
 
             bool isString(IScriptContext* ctx)  const override{ return false; } 
             bool isNumber(IScriptContext* ctx)  const override{ return false; } 
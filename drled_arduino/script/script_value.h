@@ -6,6 +6,7 @@
 #include "../lib/util/drstring.h"
 #include "../lib/util/util.h"
 #include "../lib/util/list.h"
+#include "../lib/util/wave.h"
 #include "../lib/led/led_strip.h"
 #include "../lib/led/color.h"
 #include "./script_interface.h"
@@ -16,10 +17,49 @@
 namespace DevRelief
 {
 
-    const char * functionNames[] = {
-        "rand","add","+","subtract","sub","-","multiply","*","mult",
-        "divide","div","/","mod","%","min","max","randOf","seq","sequence",
-        NULL
+    // function names are resolved to a FunctionCode once when the script is parsed
+    // so evaluation switches on an int instead of comparing strings
+    typedef enum FunctionCode {
+        FUNC_UNKNOWN=0,
+        FUNC_RAND,
+        FUNC_ADD,
+        FUNC_SUBTRACT,
+        FUNC_MULTIPLY,
+        FUNC_DIVIDE,
+        FUNC_MOD,
+        FUNC_MIN,
+        FUNC_MAX,
+        FUNC_RANDOM_OF,
+        FUNC_SEQUENCE,
+        FUNC_SIN,
+        FUNC_COS,
+        FUNC_TRIANGLE,
+        FUNC_SAW,
+        FUNC_NOISE
+    } FunctionCode;
+
+    typedef struct FunctionName {
+        const char * name;
+        FunctionCode code;
+    } FunctionName;
+
+    const FunctionName functionNames[] = {
+        {"rand",FUNC_RAND},
+        {"add",FUNC_ADD},{"+",FUNC_ADD},
+        {"subtract",FUNC_SUBTRACT},{"sub",FUNC_SUBTRACT},{"-",FUNC_SUBTRACT},
+        {"multiply",FUNC_MULTIPLY},{"*",FUNC_MULTIPLY},{"mult",FUNC_MULTIPLY},
+        {"divide",FUNC_DIVIDE},{"div",FUNC_DIVIDE},{"/",FUNC_DIVIDE},
+        {"mod",FUNC_MOD},{"%",FUNC_MOD},
+        {"min",FUNC_MIN},
+        {"max",FUNC_MAX},
+        {"randOf",FUNC_RANDOM_OF},
+        {"seq",FUNC_SEQUENCE},{"sequence",FUNC_SEQUENCE},
+        {"sin",FUNC_SIN},
+        {"cos",FUNC_COS},
+        {"triangle",FUNC_TRIANGLE},
+        {"saw",FUNC_SAW},
+        {"noise",FUNC_NOISE},
+        {NULL,FUNC_UNKNOWN}
     };
 
     // ScriptValueReference is a pointer to another ScriptValue 
@@ -56,6 +96,7 @@ namespace DevRelief
 
 
             bool isRecursing() const { return m_reference->isRecursing();} 
+            ValueVariance getVariance() const override { return m_reference->getVariance();}
 
             IJsonElement* toJson(JsonRoot* jsonRoot) { m_reference-> toJson(jsonRoot);}
             // for debugging
@@ -90,6 +131,9 @@ namespace DevRelief
 
             bool isRecursing() const override { return false;}
 
+            // values that don't know better must be evaluated for every LED
+            ValueVariance getVariance() const override { return VARIANCE_LED;}
+
             bool isString(IScriptContext* ctx)  const override{
               return false;  
             } 
@@ -144,12 +188,152 @@ namespace DevRelief
 
  
   
+    // largest name id.  ids are kept in an int16_t hash
+    #define SCRIPT_NAMES_MAX 0x7FFF
+
+    // variable names are interned into ids by each script run's RootContext.
+    // values are looked up by the name's id instead of comparing strings.
+    // the table is freed with the context so names from old scripts do not use heap
+    class ScriptNames {
+        public:
+            ScriptNames() {
+                SET_LOGGER(ScriptValueLogger);
+                m_names = NULL;
+                m_count = 0;
+                m_capacity = 0;
+                m_hash = NULL;
+                m_hashCapacity = 0;
+                // ids cached by values are only valid for the table with the same serial
+                m_serial = s_nextSerial++;
+            }
+
+            virtual ~ScriptNames() {
+                for(int id=0;id<m_count;id++) {
+                    Util::freeText(m_names[id]);
+                }
+                free(m_names);
+                free(m_hash);
+            }
+
+            // id of name.  the name is added if it is new.  -1 if there is no room
+            int getId(const char * name) {
+                if (Util::isEmpty(name)) { return -1;}
+                int slot = findSlot(name);
+                if (m_hash != NULL && m_hash[slot] >= 0) {
+                    return m_hash[slot];
+                }
+                if (m_count >= SCRIPT_NAMES_MAX) {
+                    m_logger->error("too many script names.  %s not added",name);
+                    return -1;
+                }
+                if (m_count >= m_capacity) {
+                    if (!grow()) {
+                        m_logger->error("out of memory for script name %s",name);
+                        return -1;
+                    }
+                    slot = findSlot(name);
+                }
+                int id = m_count++;
+                m_names[id] = Util::allocText(name);
+                m_hash[slot] = id;
+                return id;
+            }
+
+            // id of name or -1 if it was never interned
+            int findId(const char * name) {
+                if (Util::isEmpty(name) || m_hash == NULL) { return -1;}
+                return m_hash[findSlot(name)];
+            }
+
+            // sys values are stored with a "sys:" prefix so they cannot conflict with var() names
+            int getSysId(const char * name) {
+                char fullName[40];
+                snprintf(fullName,sizeof(fullName),"sys:%s",name ? name : "");
+                return getId(fullName);
+            }
+
+            const char * getName(int id) {
+                return (id >= 0 && id < m_count) ? m_names[id] : NULL;
+            }
+
+            int getCount() { return m_count;}
+            uint32_t getSerial() { return m_serial;}
+        private:
+            static uint32_t hash(const char * name) {
+                uint32_t h = 2166136261u;
+                while(*name) {
+                    h = (h ^ (uint8_t)*name++) * 16777619u;
+                }
+                return h;
+            }
+
+            // slot containing name's id or the empty slot where it belongs
+            int findSlot(const char * name) {
+                if (m_hash == NULL) { return 0;}
+                int mask = m_hashCapacity-1;
+                int slot = hash(name) & mask;
+                while(m_hash[slot] >= 0 && strcmp(m_names[m_hash[slot]],name) != 0) {
+                    slot = (slot+1) & mask;
+                }
+                return slot;
+            }
+
+            // double the name capacity.  the tables are unchanged if memory runs out
+            bool grow() {
+                int capacity = m_capacity == 0 ? 16 : m_capacity*2;
+                int hashCapacity = capacity*2;
+                int16_t* newHash = (int16_t*)malloc(sizeof(int16_t)*hashCapacity);
+                if (newHash == NULL) {
+                    return false;
+                }
+                char ** names = (char**)realloc(m_names,sizeof(char*)*capacity);
+                if (names == NULL) {
+                    free(newHash);
+                    return false;
+                }
+                m_names = names;
+                m_capacity = capacity;
+                free(m_hash);
+                m_hash = newHash;
+                m_hashCapacity = hashCapacity;
+                memset(m_hash,-1,sizeof(int16_t)*hashCapacity);
+                for(int id=0;id<m_count;id++) {
+                    m_hash[findSlot(m_names[id])] = id;
+                }
+                return true;
+            }
+
+            char ** m_names;
+            int m_count;
+            int m_capacity;
+            int16_t * m_hash;
+            int m_hashCapacity;
+            uint32_t m_serial;
+            DECLARE_LOGGER();
+
+            static uint32_t s_nextSerial;
+    };
+
+    uint32_t ScriptNames::s_nextSerial = 1;
+
+    // a value in a ScriptValueList.  lists in a context are keyed by the id of the name.
+    // lists created when a script is parsed keep the name and find its id when they are used
     class NameValue
     {
     public:
         NameValue(const char *name, IScriptValue *value)
         {
             m_name = Util::allocText(name);
+            m_id = -1;
+            m_namesSerial = 0;
+            m_value = value;
+        }
+
+        NameValue(int id, IScriptValue *value)
+        {
+            m_name = NULL;
+            m_id = id;
+            m_namesSerial = 0;
             m_value = value;
         }
 
@@ -162,6 +346,18 @@ namespace DevRelief
         virtual void destroy() { delete this;}
 
         const char *getName() { return m_name; }
+        int getId() { return m_id;}
+        // id of the name in a script's names.  looked up once for each table
+        int getId(ScriptNames* names) {
+            if (m_name == NULL || names == NULL) {
+                return m_id;
+            }
+            if (m_namesSerial != names->getSerial()) {
+                m_id = names->getId(m_name);
+                m_namesSerial = names->getSerial();
+            }
+            return m_id;
+        }
         IScriptValue *getValue() { return m_value; }
 
         void replaceValue(IScriptValue* newValue) {
@@ -172,26 +368,64 @@ namespace DevRelief
             m_value = newValue;
         }
     private:
-        const char * m_name;
+        char * m_name;
+        int m_id;
+        uint32_t m_namesSerial;
         IScriptValue *m_value;
     };
     // ScriptVariableGenerator: ??? rand, trig, ...
     class FunctionArgs {
         public:
-            FunctionArgs() {}
-            virtual ~FunctionArgs() {}
+            FunctionArgs() {
+                m_values = NULL;
+                m_count = 0;
+                m_capacity = 0;
+            }
+            virtual ~FunctionArgs() {
+                for(int i=0;i<m_count;i++) {
+                    if (m_values[i]) { m_values[i]->destroy();}
+                }
+                free(m_values);
+            }
 
             FunctionArgs* clone()  {
                 FunctionArgs* other = new FunctionArgs();
-                args.each([&](IScriptValue* val) {
-                    add(val->clone());
+                each([&](IScriptValue* val) {
+                    other->add(val ? val->clone() : NULL);
                 });
+                return other;
+            }
+
+            // the args own val.  it is destroyed if there is no memory to add it
+            bool add(IScriptValue* val) { 
+                if (m_count == m_capacity) {
+                    int capacity = m_capacity == 0 ? 4 : m_capacity*2;
+                    IScriptValue** values = (IScriptValue**)realloc(m_values,capacity*sizeof(IScriptValue*));
+                    if (values == NULL) {
+                        if (val) { val->destroy();}
+                        return false;
+                    }
+                    m_values = values;
+                    m_capacity = capacity;
+                }
+                m_values[m_count++] = val;
+                return true;
             }
+            // args are stored in an array so evaluation doesn't walk a list for every argument
+            IScriptValue* get(int index) { return (index>=0 && index<m_count) ? m_values[index] : NULL;}
+            size_t length() { return m_count;}
+            // release the values without destroying them.  
+            void forget() { m_count = 0;}
 
-            void add(IScriptValue* val) { args.add(val);}
-            IScriptValue* get(int index) { return args.get(index);}
-            size_t length() { return args.size();}
-            PtrList<IScriptValue*> args;
+            void each(auto&& lambda) const {
+                for(int i=0;i<m_count;i++) {
+                    lambda(m_values[i]);
+                }
+            }
+        private:
+            IScriptValue** m_values;
+            int m_count;
+            int m_capacity;
     };
 
     int randTotal = millis();
@@ -199,23 +433,33 @@ namespace DevRelief
     class ScriptFunction : public ScriptValue
     {
     public:
-        static bool isFunctionName(const char * val) {
-            if (val == NULL || val[0] == NULL) {return false;}
-            for(int i=0;functionNames[i] != NULL;i++) {
-                if (Util::equal(val,functionNames[i])){
-                    return true;
+        static FunctionCode getFunctionCode(const char * val) {
+            if (val == NULL || val[0] == 0) {return FUNC_UNKNOWN;}
+            for(int i=0;functionNames[i].name != NULL;i++) {
+                if (Util::equal(val,functionNames[i].name)){
+                    return functionNames[i].code;
                 }
             }
-            return false;
+            return FUNC_UNKNOWN;
+        }
+
+        static bool isFunctionName(const char * val) {
+            return getFunctionCode(val) != FUNC_UNKNOWN;
         }
     public:
         ScriptFunction(const char *name, FunctionArgs* args=NULL) : m_name(name)
         {
-           // randomSeed(analogRead(0)+millis());
-            if (args == NULL) {
-                m_args = new FunctionArgs();
-            } else {
-                m_args = args;
+            m_code = getFunctionCode(name);
+            m_isConstant = false;
+            m_constantValue = 0;
+            // rand, randOf and sequence return a different value each time they are called
+            bool changesPerCall = m_code == FUNC_RAND || m_code == FUNC_RANDOM_OF || m_code == FUNC_SEQUENCE;
+            m_variance = changesPerCall ? VARIANCE_LED : VARIANCE_CONSTANT;
+            m_args = new FunctionArgs();
+            if (args != NULL) {
+                args->each([&](IScriptValue* arg) { addArg(arg);});
+                args->forget();
+                delete args;
             }
             m_funcState = -1;
         }
@@ -226,10 +470,40 @@ namespace DevRelief
         }
 
         IScriptValue* clone()const override {
-            return new ScriptFunction(m_name,m_args?m_args->clone() : NULL);
+            ScriptFunction* func = new ScriptFunction(m_name,m_args?m_args->clone() : NULL);
+            func->foldConstant();
+            return func;
         }
         void addArg(IScriptValue*val) {
-            m_args->add(val);
+            if (!m_args->add(val)) {
+                m_logger->error("out of memory for %s arg %d",m_name.get(),(int)m_args->length());
+                return;
+            }
+            ValueVariance argVariance = val ? val->getVariance() : VARIANCE_CONSTANT;
+            if (argVariance > m_variance) {
+                m_variance = argVariance;
+            }
+        }
+
+        ValueVariance getVariance() const override { return m_variance;}
+
+        // called after all args are added.  if every arg is constant the result is calculated once.
+        // the function and args are kept so toJson() returns the original expression
+        void foldConstant() {
+            if (m_variance != VARIANCE_CONSTANT || (int)m_args->length() < getRequiredArgCount()) {
+                return;
+            }
+            bool hasNull = false;
+            m_args->each([&](IScriptValue* arg) {
+                hasNull = hasNull || arg == NULL || arg->isNull(NULL);
+            });
+            if (hasNull) {
+                // null args return the caller's defaultValue so the result isn't constant
+                return;
+            }
+            m_constantValue = invoke(NULL,0);
+            m_isConstant = true;
+            m_logger->never("folded constant %s=%f",m_name.get(),m_constantValue);
         }
         int getIntValue(IScriptContext* ctx,  int defaultValue) override
         {
@@ -238,6 +512,9 @@ namespace DevRelief
 
         double getFloatValue(IScriptContext* ctx,  double defaultValue) override
         {
+            if (m_isConstant) {
+                return m_constantValue;
+            }
             return invoke(ctx,defaultValue);
         }
 
@@ -262,7 +539,7 @@ namespace DevRelief
         IJsonElement* toJson(JsonRoot* root) override {
             JsonArray* json = root->createArray();
             json->addString(m_name.text());
-            m_args->args.each([&](IScriptValue*arg) {
+            m_args->each([&](IScriptValue*arg) {
                 json->addItem(arg->toJson(root));
             });
             return json;
@@ -272,34 +549,33 @@ namespace DevRelief
     protected:
         double invoke(IScriptContext * ctx,double defaultValue) {
             double result = 0;
-            const char * name = m_name.get();
-            if (Util::equal("rand",name)){
-                result = invokeRand(ctx,defaultValue);
-            } else if (Util::equal("add",name) || Util::equal("+",name)) {
-                result = invokeAdd(ctx,defaultValue);
-            } else if (Util::equal("subtract",name) ||Util::equal("sub",name) || Util::equal("-",name)) {
-                result = invokeSubtract(ctx,defaultValue);
-            } else if (Util::equal("multiply",name) || Util::equal("mult",name) || Util::equal("*",name)) {
-                result = invokeMultiply(ctx,defaultValue);
-            } else if (Util::equal("divide",name) || Util::equal("div",name) || Util::equal("/",name)) {
-                result = invokeDivide(ctx,defaultValue);
-            } else if (Util::equal("mod",name) || Util::equal("%",name)) {
-                result = invokeMod(ctx,defaultValue);
-            } else if (Util::equal("min",name)) {
-                result = invokeMin(ctx,defaultValue);
-            } else if (Util::equal("max",name)) {
-                result = invokeMax(ctx,defaultValue);
-            } else if (Util::equal("randOf",name)) {
-                result = invokeRandomOf(ctx,defaultValue);
-            } else if (Util::equal("seq",name)||Util::equal("sequence",name)) {
-                result = invokeSequence(ctx,defaultValue);
-            } else {
-                m_logger->error("unknown function: %s",name);
+            switch(m_code) {
+                case FUNC_RAND: result = invokeRand(ctx,defaultValue); break;
+                case FUNC_ADD: result = invokeAdd(ctx,defaultValue); break;
+                case FUNC_SUBTRACT: result = invokeSubtract(ctx,defaultValue); break;
+                case FUNC_MULTIPLY: result = invokeMultiply(ctx,defaultValue); break;
+                case FUNC_DIVIDE: result = invokeDivide(ctx,defaultValue); break;
+                case FUNC_MOD: result = invokeMod(ctx,defaultValue); break;
+                case FUNC_MIN: result = invokeMin(ctx,defaultValue); break;
+                case FUNC_MAX: result = invokeMax(ctx,defaultValue); break;
+                case FUNC_RANDOM_OF: result = invokeRandomOf(ctx,defaultValue); break;
+                case FUNC_SEQUENCE: result = invokeSequence(ctx,defaultValue); break;
+                case FUNC_SIN:
+                case FUNC_COS:
+                case FUNC_TRIANGLE:
+                case FUNC_SAW:
+                case FUNC_NOISE: result = invokeWave(ctx,defaultValue); break;
+                default:
+                    m_logger->error("unknown function: %s",m_name.get());
             }
             m_logger->never("function: %s=%f",m_name.get(),result);
             return result;
         }
 
+        Random* getRandom(IScriptContext* ctx) {
+            return ctx ? ctx->getRandom() : &Random::Instance;
+        }
+
         double invokeRand(IScriptContext*ctx ,double defaultValue) {
             int low = getArgValue(ctx,0,0);
             int high = getArgValue(ctx, 1,low);
@@ -311,7 +587,7 @@ namespace DevRelief
                 low = high;
                 high = t;
             }
-            int val = random(low,high+1);
+            int val = getRandom(ctx)->random(low,high+1);
             return val;
             
         }
@@ -347,7 +623,9 @@ namespace DevRelief
         double invokeMod(IScriptContext*ctx,double defaultValue) {
             double first = getArgValue(ctx,0,defaultValue);
             double second = getArgValue(ctx,1,defaultValue);
-            return (double)((int)first % (int)second);
+            int divisor = (int)second;
+            // like divide, 0 instead of a fault.  constants are folded when the script loads
+            return (divisor == 0) ? 0 : (double)((int)first % divisor);
         }
         
         double invokeMin(IScriptContext*ctx,double defaultValue) {
@@ -364,7 +642,7 @@ namespace DevRelief
 
         double invokeRandomOf(IScriptContext*ctx,double defaultValue) {
             int count = m_args->length();
-            int idx = random(count);
+            int idx = getRandom(ctx)->random(count);
             return getArgValue(ctx,idx,defaultValue);
         }
 
@@ -387,6 +665,43 @@ namespace DevRelief
             return m_funcState;
         }
 
+        // [name, x, period, low, high].  the value moves between low and high as x goes through a period.
+        // noise has a random value at every multiple of period and changes smoothly between them
+        double invokeWave(IScriptContext*ctx,double defaultValue) {
+            double x = getArgValue(ctx,0,0);
+            double period = getArgValue(ctx,1,100);
+            double low = getArgValue(ctx,2,0);
+            double high = getArgValue(ctx,3,100);
+            double value = 0;
+            switch(m_code) {
+                case FUNC_SIN: value = Wave::sine(Wave::toPhase(x,period)); break;
+                case FUNC_COS: value = Wave::cosine(Wave::toPhase(x,period)); break;
+                case FUNC_TRIANGLE: value = Wave::triangle(Wave::toPhase(x,period)); break;
+                case FUNC_SAW: value = Wave::saw(Wave::toPhase(x,period)); break;
+                case FUNC_NOISE: value = period > 0 ? Wave::noise(x/period) : 0; break;
+                default: break;
+            }
+            return low + (high-low)*value;
+        }
+
+        int getRequiredArgCount() {
+            switch(m_code) {
+                case FUNC_SUBTRACT:
+                case FUNC_SIN:
+                case FUNC_COS:
+                case FUNC_TRIANGLE:
+                case FUNC_SAW:
+                case FUNC_NOISE: return 1;
+                case FUNC_ADD:
+                case FUNC_MULTIPLY:
+                case FUNC_DIVIDE:
+                case FUNC_MOD:
+                case FUNC_MIN:
+                case FUNC_MAX: return 2;
+                default: return 0;
+            }
+        }
+
         double getArgValue(IScriptContext*ctx, int idx, double defaultValue){
             if (m_args == NULL) {
                 return defaultValue;
@@ -397,7 +712,11 @@ namespace DevRelief
         }
 
         DRString m_name;
+        FunctionCode m_code;
         FunctionArgs * m_args;
+        ValueVariance m_variance;
+        bool m_isConstant;
+        double m_constantValue;
         double m_funcState; // different functions can use in their way
     };
 
@@ -446,6 +765,7 @@ namespace DevRelief
         IJsonElement* toJson(JsonRoot*root) override { return new JsonFloat(root,m_value);}
         DRString stringify() override { return DRString::fromFloat(m_value);}
         IScriptValue* clone() const override{ return new ScriptNumberValue(m_value);}
+        ValueVariance getVariance() const override { return VARIANCE_CONSTANT;}
 
         void setNumberValue(double val) { m_value = val;}
     protected:
@@ -493,6 +813,7 @@ namespace DevRelief
 
         DRString stringify() override { return m_value ? "true":"false";}
         IScriptValue* clone() const override{ return new ScriptBoolValue(m_value);}
+        ValueVariance getVariance() const override { return VARIANCE_CONSTANT;}
 
     protected:
         bool m_value;
@@ -618,6 +939,7 @@ namespace DevRelief
         IScriptValue* clone()const override {
             return new ScriptStringValue(m_value);
         }
+        ValueVariance getVariance() const override { return VARIANCE_CONSTANT;}
     protected:
         DRString m_value;
     };
@@ -670,20 +992,101 @@ namespace DevRelief
 
  
 
+// largest position domain a pattern is rasterized for
+#define PATTERN_RASTER_LIMIT 2048
+
+    class InterpolationSegment {
+        public:
+        InterpolationSegment() {
+            startElementIndex=0;
+            endElementIndex=0;
+            startPercent=0;
+            endPercent=1;
+        }
+        ~InterpolationSegment() {}
+        int startElementIndex;
+        int endElementIndex;
+        double startPercent;
+        double endPercent;
+    };
+
+    // segments are kept in an array in pattern order.  
+    // each segment starts where the previous one ends so they can be searched by percent
     class PatternInterpolation {
         public:
             PatternInterpolation() {
                 SET_LOGGER(ScriptValueLogger);
+                m_segments = NULL;
+                m_segmentCount = 0;
+                m_cursor = 0;
             }
             virtual ~PatternInterpolation() {
+                delete [] m_segments;
             }
 
             void destroy() { delete this;}
 
-            virtual UnitValue getValue(double pct, IScriptContext* ctx, LinkedList<ScriptPatternElement*>& elements,int pixelCount, double defaultValue, PositionUnit defaultUnit)=0;
+            virtual UnitValue getValue(double pct, IScriptContext* ctx, ScriptPatternElement** elements, int elementCount, int pixelCount, double defaultValue, PositionUnit defaultUnit)=0;
 
             virtual bool toJson(JsonObject* json)const =0;
         protected:
+            // segments are only reallocated if the count changes
+            void setSegmentCount(int count) {
+                if (count != m_segmentCount) {
+                    delete [] m_segments;
+                    m_segments = count > 0 ? new InterpolationSegment[count] : NULL;
+                    m_segmentCount = count;
+                }
+                m_cursor = 0;
+            }
+
+            InterpolationSegment* getSegment(int index) {
+                return (index >= 0 && index < m_segmentCount) ? &m_segments[index] : NULL;
+            }
+
+            ScriptPatternElement* getElement(ScriptPatternElement** elements, int elementCount, int index) {
+                return (index >= 0 && index < elementCount) ? elements[index] : NULL;
+            }
+
+            // the segment with startPercent <= pct < endPercent.  
+            // LEDs are usually drawn in order so the last segment found and the next one are checked 
+            // before a binary search
+            InterpolationSegment* searchSegments(double pct) {
+                if (m_segmentCount == 0) {
+                    return NULL;
+                }
+                if (segmentContains(m_cursor,pct)) {
+                    return &m_segments[m_cursor];
+                }
+                if (m_cursor+1 < m_segmentCount && segmentContains(m_cursor+1,pct)) {
+                    m_cursor++;
+                    return &m_segments[m_cursor];
+                }
+                // last segment starting at or before pct
+                int low = 0;
+                int high = m_segmentCount-1;
+                while(low < high) {
+                    int mid = (low+high+1)/2;
+                    if (m_segments[mid].startPercent <= pct) {
+                        low = mid;
+                    } else {
+                        high = mid-1;
+                    }
+                }
+                if (segmentContains(low,pct)) {
+                    m_cursor = low;
+                    return &m_segments[low];
+                }
+                return NULL;
+            }
+
+            bool segmentContains(int index, double pct) {
+                return m_segments[index].startPercent <= pct && m_segments[index].endPercent > pct;
+            }
+
+            InterpolationSegment* m_segments;
+            int m_segmentCount;
+            int m_cursor;
             DECLARE_LOGGER();
 
     };
@@ -696,12 +1099,25 @@ namespace DevRelief
 
             m_pixelCount = 0;
             m_interpolation = NULL;
-
+            m_elementArray = NULL;
+            m_elementCount = 0;
+            m_rasterMode = RASTER_UNKNOWN;
+            m_raster = NULL;
+            m_rasterSize = 0;
+            m_rasterLength = 0;
+            m_rasterStep = -1;
+            m_rasterElement = NULL;
+            m_rasterMin = 0;
+            m_rasterMax = 0;
+            m_rasterDefault = 0;
+            m_rasterDefaultUnit = POS_UNSET;
         }
 
         virtual ~PatternValue()
         {
            if (m_interpolation) { m_interpolation->destroy();}
+           free(m_elementArray);
+           free(m_raster);
         }
 
         IScriptValue* clone()const override {
@@ -715,6 +1131,15 @@ namespace DevRelief
                 return;
             }
             m_elements.add(element);
+            // m_elements owns the elements.  the array is for indexed access while drawing
+            // without memory the element is still owned and freed but is not drawn
+            ScriptPatternElement** elements = (ScriptPatternElement**)realloc(m_elementArray,sizeof(ScriptPatternElement*)*(m_elementCount+1));
+            if (elements == NULL) {
+                m_logger->error("no memory for pattern element %d",m_elementCount);
+                return;
+            }
+            m_elementArray = elements;
+            m_elementArray[m_elementCount++] = element;
             m_pixelCount += element->getPixelCount();
         }
 
@@ -725,24 +1150,22 @@ namespace DevRelief
             if (m_animator == NULL) {
                 return UnitValue(defaultValue,defaultUnit);
             }
-            m_pixelCount = 0;
-            m_elements.each([&](ScriptPatternElement* element) {
-                element->update(ctx);
-                m_pixelCount += element->getPixelCount();
-            });
-            m_animator->update(ctx);
-
-            double pct = m_animator->getRangeValue(ctx);
-            PositionUnit unit = m_animator->getUnit();
-            if (unit == POS_UNSET) {
-                unit = defaultUnit;
+            if (canRasterize(ctx)) {
+                PositionDomain* domain = ctx->getAnimationPositionDomain();
+                if (isRasterCurrent(ctx,domain,defaultValue,defaultUnit)) {
+                    if (m_rasterLength == 0) {
+                        rasterize(ctx,domain,defaultValue,defaultUnit);
+                    }
+                    double index = domain->getValue()-m_rasterMin;
+                    int led = (int)index;
+                    if (led == index && led >= 0 && led < m_rasterLength) {
+                        return UnitValue(m_raster[led].value,(PositionUnit)m_raster[led].unit);
+                    }
+                }
             }
-            UnitValue value = m_interpolation->getValue(pct,ctx,m_elements,m_pixelCount,defaultValue,unit); 
-            m_logger->never("patternvalue: %f",value.getValue());
-            //UnitValue val = getValueAt(ctx,  value,defaultValue,POS_INHERIT);
-            return value;
+            return calculateValue(ctx,defaultValue,defaultUnit);
         }
-   
+
         IJsonElement* toJson(JsonRoot* jsonRoot) { 
             m_logger->never("PatternValue.toJson");
             JsonObject* json = jsonRoot->getTopObject();
@@ -797,11 +1220,129 @@ namespace DevRelief
         void setInterpolation(PatternInterpolation*interpolation) { m_interpolation = interpolation;}
 
     protected:
+        typedef enum RasterMode {
+            RASTER_UNKNOWN=0,
+            RASTER_ON,
+            RASTER_OFF
+        } RasterMode;
+
+        // one value for each position of the domain
+        struct RasterValue {
+            double value;
+            uint8_t unit;
+        };
+
+        UnitValue calculateValue(IScriptContext*ctx, double defaultValue, PositionUnit defaultUnit) {
+            updateElements(ctx);
+            return getAnimatedValue(ctx,defaultValue,defaultUnit);
+        }
+
+        void updateElements(IScriptContext* ctx) {
+            m_pixelCount = 0;
+            for(int i=0;i<m_elementCount;i++) {
+                m_elementArray[i]->update(ctx);
+                m_pixelCount += m_elementArray[i]->getPixelCount();
+            }
+        }
+
+        // the value at the current position.  elements must be updated
+        UnitValue getAnimatedValue(IScriptContext*ctx, double defaultValue, PositionUnit defaultUnit) {
+            m_animator->update(ctx);
+
+            double pct = m_animator->getRangeValue(ctx);
+            PositionUnit unit = m_animator->getUnit();
+            if (unit == POS_UNSET) {
+                unit = defaultUnit;
+            }
+            UnitValue value = m_interpolation->getValue(pct,ctx,m_elementArray,m_elementCount,m_pixelCount,defaultValue,unit); 
+            m_logger->never("patternvalue: %f",value.getValue());
+            return value;
+        }
+
+        // the pattern can be computed once per step if nothing in it changes per LED
+        // except the position domain
+        bool canRasterize(IScriptContext* ctx) {
+            if (m_rasterMode == RASTER_UNKNOWN) {
+                bool on = m_interpolation != NULL && m_animator->isPositionAnimation();
+                for(int i=0;on && i<m_elementCount;i++) {
+                    IScriptValue* value = m_elementArray[i]->getValue();
+                    IScriptValue* count = m_elementArray[i]->getRepeatCount();
+                    on = (value == NULL || value->getVariance() != VARIANCE_LED) &&
+                        (count == NULL || count->getVariance() != VARIANCE_LED);
+                }
+                m_rasterMode = on ? RASTER_ON : RASTER_OFF;
+            }
+            if (m_rasterMode == RASTER_OFF || ctx == NULL || ctx->getStep() == NULL) {
+                return false;
+            }
+            PositionDomain* domain = ctx->getAnimationPositionDomain();
+            return domain != NULL && domain->getMin() <= domain->getMax() && 
+                domain->getDistance() <= PATTERN_RASTER_LIMIT;
+        }
+
+        // the first read of a step (or of a new element or domain) is calculated directly.
+        // the raster is only built by the second read so values read once per step (e.g. an offset) 
+        // don't compute every position
+        bool isRasterCurrent(IScriptContext* ctx, PositionDomain* domain, double defaultValue, PositionUnit defaultUnit) {
+            int step = ctx->getStep()->getNumber();
+            IScriptElement* element = ctx->getCurrentElement();
+            if (step == m_rasterStep && element == m_rasterElement && domain->getMin() == m_rasterMin &&
+                domain->getMax() == m_rasterMax && defaultValue == m_rasterDefault && defaultUnit == m_rasterDefaultUnit) {
+                return true;
+            }
+            m_rasterStep = step;
+            m_rasterElement = element;
+            m_rasterMin = domain->getMin();
+            m_rasterMax = domain->getMax();
+            m_rasterDefault = defaultValue;
+            m_rasterDefaultUnit = defaultUnit;
+            m_rasterLength = 0;
+            return false;
+        }
+
+        // elements are updated once then the value is calculated at every position in order.  
+        // the buffer is reused unless the domain grows
+        void rasterize(IScriptContext* ctx, PositionDomain* domain, double defaultValue, PositionUnit defaultUnit) {
+            int length = domain->getDistance();
+            if (length > m_rasterSize) {
+                RasterValue* raster = (RasterValue*)realloc(m_raster,sizeof(RasterValue)*length);
+                if (raster == NULL) {
+                    m_logger->error("no memory for pattern raster %d",length);
+                    m_rasterMode = RASTER_OFF;
+                    return;
+                }
+                m_raster = raster;
+                m_rasterSize = length;
+            }
+            double pos = domain->getValue();
+            updateElements(ctx);
+            for(int i=0;i<length;i++) {
+                domain->setPos(m_rasterMin+i);
+                UnitValue value = getAnimatedValue(ctx,defaultValue,defaultUnit);
+                m_raster[i].value = value.getValue();
+                m_raster[i].unit = value.getUnit();
+            }
+            domain->setPos(pos);
+            m_rasterLength = length;
+        }
+
         StepWatcher m_watcher;
         PatternInterpolation* m_interpolation;
         PtrList<ScriptPatternElement*> m_elements;
+        ScriptPatternElement** m_elementArray;
+        int m_elementCount;
         size_t m_pixelCount;
-       
+
+        RasterMode m_rasterMode;
+        RasterValue* m_raster;
+        int m_rasterSize;
+        int m_rasterLength;
+        int m_rasterStep;
+        IScriptElement* m_rasterElement;
+        double m_rasterMin;
+        double m_rasterMax;
+        double m_rasterDefault;
+        PositionUnit m_rasterDefaultUnit;
     };
     
     void ScriptPatternElement::update(IScriptContext* ctx) {
@@ -823,22 +1364,6 @@ namespace DevRelief
         }
     }
 
-    class InterpolationSegment {
-        public:
-        InterpolationSegment() {
-            startElementIndex=0;
-            endElementIndex=0;
-            startPercent=0;
-            endPercent=1;
-        }
-        ~InterpolationSegment() {}
-        void destroy() { delete this;}
-        int startElementIndex;
-        int endElementIndex;
-        double startPercent;
-        double endPercent;
-    };
-
 
     class SmoothInterpolation : public PatternInterpolation {
         public:
@@ -850,15 +1375,15 @@ namespace DevRelief
 
             }
 
-            UnitValue getValue(double pct, IScriptContext* ctx, LinkedList<ScriptPatternElement*>& elements,int pixelCount, double defaultValue, PositionUnit defaultUnit) {
+            UnitValue getValue(double pct, IScriptContext* ctx, ScriptPatternElement** elements, int elementCount, int pixelCount, double defaultValue, PositionUnit defaultUnit) {
                 if (m_stepWatcher.isChanged(ctx)) {
                     m_logger->debug(LM("update SmoothInterpolation segments"));
-                    setupSegments(elements,pixelCount);
+                    setupSegments(elements,elementCount,pixelCount);
                 }
-                InterpolationSegment* segment = findSegment(pct,elements);
+                InterpolationSegment* segment = findSegment(pct);
                 if (segment != NULL) {
-                    ScriptPatternElement* start = elements.get(segment->startElementIndex);
-                    ScriptPatternElement* end = elements.get(segment->endElementIndex);
+                    ScriptPatternElement* start = getElement(elements,elementCount,segment->startElementIndex);
+                    ScriptPatternElement* end = getElement(elements,elementCount,segment->endElementIndex);
                     if (start != NULL && start->getValue() != NULL && end == NULL){
                         m_logger->never("no start.  return end value");
                         return start->getValue()->getUnitValue(ctx,defaultValue,defaultUnit);
@@ -885,12 +1410,11 @@ namespace DevRelief
                 return true;
             }
         protected:
-            void setupSegments(LinkedList<ScriptPatternElement*>& elements,int totalPixels) {
-                int elementCount = elements.size();
+            void setupSegments(ScriptPatternElement** elements, int elementCount, int totalPixels) {
                 if (elementCount<3) {
-                    m_segments.clear();
+                    setSegmentCount(elementCount==0 ? 0 : 1);
                     if (elementCount==0) { return;}
-                    InterpolationSegment* seg = new InterpolationSegment();
+                    InterpolationSegment* seg = &m_segments[0];
                     seg->startElementIndex = 0;
                     seg->endElementIndex = -1;
                     seg->startPercent = 0;
@@ -898,27 +1422,17 @@ namespace DevRelief
                     if (elementCount==2) {
                         seg->endElementIndex=1;
                     }
-                    m_segments.add(seg);
                     return;
 
                 }
-               if (elements.size() != m_segments.size()+1){
-                    m_segments.clear();
-                    for(int i=0;i<elements.size()-1;i++) {
-                        m_segments.add(new InterpolationSegment());
-                    }
-                }
+                setSegmentCount(elementCount-1);
                 double pixelOffset = 0;
-                int startElementIndex = 0;
-                int endElementIndex = 0;
                 double startPct = 0;
-                double endPct = 0;
-                int segmentIndex = 0;
 
                 for(int elementIndex=0;elementIndex<elementCount-1;elementIndex++) {
-                    InterpolationSegment* segment = m_segments.get(elementIndex);
-                    ScriptPatternElement* start = elements.get(elementIndex);                    
-                    ScriptPatternElement* end = elements.get(elementIndex+1);
+                    InterpolationSegment* segment = &m_segments[elementIndex];
+                    ScriptPatternElement* start = elements[elementIndex];                    
+                    ScriptPatternElement* end = elements[elementIndex+1];
                     segment->startElementIndex = elementIndex;
                     segment->endElementIndex = elementIndex+1;
 
@@ -937,23 +1451,15 @@ namespace DevRelief
 
             }
 
-            InterpolationSegment* findSegment(double pct,LinkedList<ScriptPatternElement*>& elements) {
-                m_logger->never("find segment %.2f of %d",pct,m_segments.size());
-               if (pct == 0 || m_segments.size() <= 2) {
-                    return m_segments.get(0);
+            InterpolationSegment* findSegment(double pct) {
+                m_logger->never("find segment %.2f of %d",pct,m_segmentCount);
+               if (pct == 0 || m_segmentCount <= 2) {
+                    return getSegment(0);
                 }
                 if (pct >= 1) {
-                    return m_segments.get(m_segments.size()-1);
+                    return getSegment(m_segmentCount-1);
                 }
-                for(int i=0;i<m_segments.size();i++) {
-                    InterpolationSegment* segment = m_segments.get(i);
-                    if (segment->startPercent<=pct && segment->endPercent > pct) {
-                        return segment;
-                    }
-                    m_logger->never("\tno match %.2f < %.2f < %.2f",segment->startPercent,pct,segment->endPercent);
-
-                }
-                return NULL;
+                return searchSegments(pct);
             }
 
             virtual UnitValue interpolate(IScriptContext*ctx, IScriptValue*start,IScriptValue*end, double pct, double defaultValue, PositionUnit defaultUnit){
@@ -980,7 +1486,6 @@ namespace DevRelief
             }     
 
             StepWatcher m_stepWatcher;  
-            PtrList<InterpolationSegment*> m_segments;    
     };
 
     class StepInterpolation : public PatternInterpolation {
@@ -991,13 +1496,13 @@ namespace DevRelief
 
             }
 
-            UnitValue getValue(double pct, IScriptContext* ctx, LinkedList<ScriptPatternElement*>& elements,int totalPixels, double defaultValue, PositionUnit defaultUnit) {
+            UnitValue getValue(double pct, IScriptContext* ctx, ScriptPatternElement** elements, int elementCount, int totalPixels, double defaultValue, PositionUnit defaultUnit) {
                 if (m_stepWatcher.isChanged(ctx)) {
-                    setupSegments(elements,totalPixels);
+                    setupSegments(elements,elementCount,totalPixels);
                 }
-                InterpolationSegment* segment = findSegment(pct,elements);
+                InterpolationSegment* segment = findSegment(pct);
                 if (segment) {
-                    ScriptPatternElement*element = elements.get(segment->startElementIndex);
+                    ScriptPatternElement*element = getElement(elements,elementCount,segment->startElementIndex);
                     IScriptValue* val = element ? element->getValue() : NULL;
                     if (val) {
                         return val->getUnitValue(ctx,defaultValue,defaultUnit);
@@ -1011,43 +1516,28 @@ namespace DevRelief
                 return true;
             }
         protected:
-            void setupSegments(LinkedList<ScriptPatternElement*>& elements,int totalPixels) {
-                if (elements.size() != m_segments.size()){
-                    m_segments.clear();
-                    for(int i=0;i<elements.size();i++) {
-                        m_segments.add(new InterpolationSegment());
-                    }
-                }
+            void setupSegments(ScriptPatternElement** elements, int elementCount, int totalPixels) {
+                setSegmentCount(elementCount);
                 double pixelOffset = 0;
-                int index = 0;
-                int pct = 0;
-                elements.each([&](ScriptPatternElement* element){
-                    InterpolationSegment* segment = m_segments.get(index);
+                for(int index=0;index<elementCount;index++) {
+                    InterpolationSegment* segment = &m_segments[index];
                     segment->startElementIndex = index;
                     segment->endElementIndex = index;
                     segment->startPercent = pixelOffset/totalPixels;
-                    index++;
-                    pixelOffset += element->getPixelCount();
+                    pixelOffset += elements[index]->getPixelCount();
                     segment->endPercent = pixelOffset/totalPixels;
-                });
+                }
             }
 
-            InterpolationSegment* findSegment(double pct,LinkedList<ScriptPatternElement*>& elements) {
+            InterpolationSegment* findSegment(double pct) {
                 if (pct <= 0) {
-                    return m_segments.get(0);
+                    return getSegment(0);
                 }
                 if (pct >= 1) {
-                    return m_segments.get(m_segments.size()-1);
+                    return getSegment(m_segmentCount-1);
                 }
-                for(int i=0;i<m_segments.size();i++) {
-                    InterpolationSegment* segment = m_segments.get(i);
-                    if (segment->startPercent<=pct && segment->endPercent > pct) {
-                        return segment;
-                    }
-                }
-                return NULL;
+                return searchSegments(pct);
             }
-            PtrList<InterpolationSegment*> m_segments;        
             StepWatcher m_stepWatcher;   
     };
 
@@ -1146,6 +1636,18 @@ namespace DevRelief
             bool m_alternate;
     };
 
+    // sys() values computed from the context instead of looked up by name
+    typedef enum SysValueId {
+        SYS_VALUE_NAMED=0,  // a value stored in the context (e.g. sys(red))
+        SYS_VALUE_OFFSET,
+        SYS_VALUE_LENGTH,
+        SYS_VALUE_LED,
+        SYS_VALUE_STEP
+    } SysValueId;
+
+    // reads a sys() value directly from the context
+    typedef double (*SysValueAccessor)(IScriptContext* ctx);
+
     class ScriptVariableValue : public IScriptValue
     {
     public:
@@ -1157,6 +1659,10 @@ namespace DevRelief
             m_defaultValue = defaultValue;
             m_isSysValue = isSysValue;
             m_recurse = false;
+            m_sysId = isSysValue ? getSysValueId(value) : SYS_VALUE_NAMED;
+            m_nameId = -1;
+            m_namesSerial = 0;
+            m_accessor = getSysValueAccessor(m_sysId);
         }
 
         ScriptVariableValue(const ScriptVariableValue* other){
@@ -1164,6 +1670,54 @@ namespace DevRelief
             m_defaultValue = other->m_defaultValue ? other->m_defaultValue->clone() : NULL;
             m_isSysValue = other->m_isSysValue;
             m_recurse = false;
+            m_sysId = other->m_sysId;
+            m_nameId = -1;
+            m_namesSerial = 0;
+            m_accessor = other->m_accessor;
+        }
+
+        static SysValueId getSysValueId(const char * name) {
+            if (Util::equal("offset",name)) { return SYS_VALUE_OFFSET;}
+            if (Util::equal("length",name)) { return SYS_VALUE_LENGTH;}
+            if (Util::equal("led",name)) { return SYS_VALUE_LED;}
+            if (Util::equal("step",name)) { return SYS_VALUE_STEP;}
+            return SYS_VALUE_NAMED;
+        }
+
+        static SysValueAccessor getSysValueAccessor(SysValueId id) {
+            switch(id) {
+                case SYS_VALUE_OFFSET: return &getSysOffset;
+                case SYS_VALUE_LENGTH: return &getSysLength;
+                case SYS_VALUE_LED: return &getSysLed;
+                case SYS_VALUE_STEP: return &getSysStep;
+                default: return NULL;
+            }
+        }
+
+        static double getSysOffset(IScriptContext* ctx) {
+            IElementPosition*pos = ctx->getPosition();
+            if (pos && pos->hasLength()) {
+                return pos->getOffset().getValue();
+            } else {
+                return 0;
+            }
+        }
+
+        static double getSysLength(IScriptContext* ctx) {
+            IElementPosition*pos = ctx->getPosition();
+            if (pos && pos->hasLength()) {
+                return pos->getLength().getValue();
+            } else {
+                return ctx->getStrip()->getLength();
+            }
+        }
+
+        static double getSysLed(IScriptContext* ctx) {
+            return ctx->getAnimationPositionDomain()->getValue();
+        }
+
+        static double getSysStep(IScriptContext* ctx) {
+            return ctx->getStep()->getNumber();
         }
 
         virtual ~ScriptVariableValue()
@@ -1182,34 +1736,13 @@ namespace DevRelief
 
         virtual double getFloatValue(IScriptContext*ctx,  double defaultValue)  override
         {
+            if (m_accessor) {
+                return m_accessor(ctx);
+            }
             if (m_recurse) {
                 m_logger->never("variable getFloatValue() recurse");
                 return m_defaultValue ? m_defaultValue->getFloatValue(ctx,defaultValue) : defaultValue;
             }
-            if (m_isSysValue && Util::equal("offset",m_name)){
-                IElementPosition*pos = ctx->getPosition();
-                if (pos && pos->hasLength()) {
-                    return pos->getOffset().getValue();
-                } else {
-                    return 0;
-                }
-            }
-            if (m_isSysValue && Util::equal("length",m_name)){
-                IElementPosition*pos = ctx->getPosition();
-                if (pos && pos->hasLength()) {
-                    return pos->getLength().getValue();
-                } else {
-                    return ctx->getStrip()->getLength();
-                }
-            }
-            if (m_isSysValue && Util::equal("led",m_name)){
-                return ctx->getAnimationPositionDomain()->getValue();
-            }
-            if (m_isSysValue && Util::equal("step",m_name)){
-                int step =  ctx->getStep()->getNumber();
-                m_logger->never("sys(step)=%d  %x",step,ctx);
-                return step;
-            }
             m_recurse = true;
 
             IScriptValue * val = getScriptValue(ctx);
@@ -1243,18 +1776,25 @@ namespace DevRelief
         }
 
         int getMsecValue(IScriptContext* ctx,  int defaultValue) override { 
+            if (m_accessor) {
+                return m_accessor(ctx);
+            }
             IScriptValue * val = getScriptValue(ctx);
 
             return val ? val->getMsecValue(ctx,defaultValue) : defaultValue;
         }
 
         UnitValue getUnitValue(IScriptContext* ctx,  double defaultValue, PositionUnit defaultUnit) override { 
+            if (m_accessor) {
+                return UnitValue(m_accessor(ctx),defaultUnit);
+            }
             IScriptValue * val = getScriptValue(ctx);
 
             return val ? val->getUnitValue(ctx,defaultValue,defaultUnit) : UnitValue(defaultValue,defaultUnit);
         }
 
         bool isNumber(IScriptContext* ctx) const { 
+            if (m_accessor) { return true;}
             IScriptValue * val = getScriptValue(ctx);
             return val ? val->isNumber(ctx) : false;
 
@@ -1307,6 +1847,14 @@ namespace DevRelief
 
         bool isRecursing() const { return m_recurse;}
 
+        ValueVariance getVariance() const override {
+            if (!m_isSysValue) {
+                // var() can reference any value in the context, including ones that change per LED
+                return VARIANCE_LED;
+            }
+            return m_sysId == SYS_VALUE_LED ? VARIANCE_LED : VARIANCE_FRAME;
+        }
+
         DRString stringify() { return "";} // cannot stringify vars
         IScriptValue* clone()const override {
             m_logger->error(LM("AnimatedValue.clone() not implemented"));
@@ -1314,15 +1862,33 @@ namespace DevRelief
         }
     protected:
         IScriptValue* getScriptValue(IScriptContext*context) const {
-            IScriptValue* val = m_isSysValue ? context->getSysValue(m_name) : context->getValue(m_name);
+            IScriptValue* val = context->getValueById(getNameId(context));
             if (val == NULL)  {
                 val = m_defaultValue;
             }
 
             return val ? val : &NULL_VALUE;
         }
+        // the name's id in the context's ScriptNames.  looked up the first time the script's context is used
+        int getNameId(IScriptContext* context) const {
+            ScriptNames* names = context->getNames();
+            if (names == NULL) {
+                return -1;
+            }
+            if (m_namesSerial != names->getSerial()) {
+                m_nameId = m_isSysValue ? names->getSysId(m_name) : names->getId(m_name);
+                m_namesSerial = names->getSerial();
+            }
+            return m_nameId;
+        }
+
         const char * m_name;
         bool m_isSysValue;
+        SysValueId m_sysId;
+        mutable int m_nameId;
+        mutable uint32_t m_namesSerial;
+        // set for sys() values that are read from the context instead of looked up
+        SysValueAccessor m_accessor;
         IScriptValue*  m_defaultValue;
         DECLARE_LOGGER();
         bool m_recurse;
@@ -1332,11 +1898,17 @@ namespace DevRelief
 
     ScriptNullValue ScriptVariableValue::NULL_VALUE;
 
+    // values are kept in a list to preserve order.  
+    // a context's list has the script's names and an open-addressing hash by name id for lookups.
+    // lists without names are created when a script is parsed and are searched by name
     class ScriptValueList : public IScriptValueProvider {
         public:
-            ScriptValueList() {
+            ScriptValueList(ScriptNames* names=NULL) {
                 SET_LOGGER(ScriptValueLogger);
                 m_logger->never("create ScriptValueList()");
+                m_names = names;
+                m_index = NULL;
+                m_indexCapacity = 0;
             }
 
 
@@ -1353,36 +1925,49 @@ namespace DevRelief
             
             IScriptValue *getValue(const char *name)  override {
                 m_logger->never("getValue %s",name);
-                NameValue** first = m_values.first([&](NameValue*&nv) {
-
-                    return strcmp(nv->getName(),name)==0;
-                });
-                if (first) {
-                    IScriptValue* found = (*first)->getValue();
-                    if (found) {
-                        m_logger->never("\tfound %s",found->toString().text());
-                        return found;
-                    }
+                if (m_names) {
+                    return getValueById(m_names->findId(name));
                 }
+                NameValue* nv = findName(name);
+                return nv ? nv->getValue() : NULL;
+            }
 
-                m_logger->never("\tnot found");
-                return NULL;
+            IScriptValue *getValueById(int id)  override {
+                if (id < 0 || m_index == NULL) { return NULL;}
+                NameValue* nv = m_index[findSlot(id)];
+                return nv ? nv->getValue() : NULL;
             }
 
             void setValue(const char * name,IScriptValue * value) {
                 if (Util::isEmpty(name) || value == NULL) {
                     return;
                 }
-                NameValue** find = m_values.first([&](NameValue*&nv) {
-                    return strcmp(nv->getName(),name)==0;
-                });
+                if (m_names) {
+                    setValueById(m_names->getId(name),value);
+                    return;
+                }
+                NameValue* find = findName(name);
                 if (find) {
-                    (*find)->replaceValue(value);
+                    find->replaceValue(value);
+                } else {
+                    m_values.add(new NameValue(name,value));
+                }
+            }
+
+            void setValueById(int id,IScriptValue * value) override {
+                if (id < 0 || value == NULL || m_names == NULL) {
+                    if (value) { value->destroy();}
                     return;
                 }
-                m_logger->never("add NameValue %s  0x%04X",name,value);
-                NameValue* nv = new NameValue(name,value);
-                m_values.add(nv);
+                if (m_index != NULL) {
+                    NameValue* find = m_index[findSlot(id)];
+                    if (find) {
+                        find->replaceValue(value);
+                        return;
+                    }
+                }
+                m_logger->never("add NameValue %d  0x%04X",id,value);
+                add(new NameValue(id,value));
             }
 
             void each(auto&& lambda) const {
@@ -1395,21 +1980,68 @@ namespace DevRelief
 
             void initialize(ScriptValueList* source,IScriptContext*ctx) override {
                 m_logger->never("initialize ScriptValueList from source %x",source);
-                m_values.clear();
+                clear();
                 if(source == NULL) { return;}
                 source->each([&](NameValue* nv) {
                     IScriptValue* val = nv->getValue();
                     if (val != NULL) {
                         IScriptValue* newVal = val->eval(ctx);
-                        NameValue*newNV = new NameValue(nv->getName(),newVal);
-                        m_values.add(newNV);
+                        if (m_names) {
+                            setValueById(nv->getId(m_names),newVal);
+                        } else {
+                            setValue(nv->getName(),newVal);
+                        }
                     }
                 });
             }
 
-            void clear() { m_values.clear();}
+            void clear() { 
+                m_values.clear();
+                free(m_index);
+                m_index = NULL;
+                m_indexCapacity = 0;
+            }
         private:
+            NameValue* findName(const char * name) {
+                NameValue** first = m_values.first([&](NameValue*&nv) {
+                    return nv->getName() != NULL && strcmp(nv->getName(),name)==0;
+                });
+                return first ? *first : NULL;
+            }
+
+            void add(NameValue* nv) {
+                m_values.add(nv);
+                if (m_values.size()*2 > m_indexCapacity) {
+                    reindex(m_indexCapacity == 0 ? 8 : m_indexCapacity*2);
+                } else {
+                    m_index[findSlot(nv->getId())] = nv;
+                }
+            }
+
+            // slot containing the id or the empty slot where it belongs
+            int findSlot(int id) const {
+                int mask = m_indexCapacity-1;
+                int slot = id & mask;
+                while(m_index[slot] != NULL && m_index[slot]->getId() != id) {
+                    slot = (slot+1) & mask;
+                }
+                return slot;
+            }
+
+            void reindex(int capacity) {
+                free(m_index);
+                m_indexCapacity = capacity;
+                m_index = (NameValue**)malloc(sizeof(NameValue*)*capacity);
+                memset(m_index,0,sizeof(NameValue*)*capacity);
+                m_values.each([&](NameValue* nv) {
+                    m_index[findSlot(nv->getId())] = nv;
+                });
+            }
+
             PtrList<NameValue*> m_values;
+            ScriptNames* m_names;
+            NameValue** m_index;
+            int m_indexCapacity;
             DECLARE_LOGGER();
    };
 
@@ -1487,6 +2119,7 @@ namespace DevRelief
             for(int i=1;i<count;i++){
                 func->addArg(create(json->getAt(i),parent));
             }
+            func->foldConstant();
             return func;
        } else {
             bool unfold = parent ? parent->getBool("unfold",false) : false;
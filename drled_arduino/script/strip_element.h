@@ -30,72 +30,340 @@ namespace DevRelief
 
     };
 
-    class MirrorStrip : public ScriptHSLStrip {
+    // one value and operation per LED for each channel of a strip segment.
+    // LEDs that have not been set hold HSL_SPAN_SKIP so a run of values can be passed to setSpan().
+    // memory only grows so drawing each frame does not allocate.
+    class SegmentBuffer {
         public:
-            MirrorStrip() : ScriptHSLStrip() {
-                m_lastLed = 0;
+            SegmentBuffer() {
+                m_capacity = 0;
+                m_length = 0;
+                m_values = NULL;
+                m_ops = NULL;
+                for(int c=0;c<3;c++) { m_pending[c] = 0;}
+            }
+
+            virtual ~SegmentBuffer() {
+                delete [] m_values;
+                delete [] m_ops;
+            }
+
+            void begin(int length) {
+                if (length > m_capacity) {
+                    delete [] m_values;
+                    delete [] m_ops;
+                    m_values = new int16_t[length*3];
+                    m_ops = new uint8_t[length*3];
+                    m_capacity = length;
+                    for(int i=0;i<m_capacity*3;i++) { m_values[i] = HSL_SPAN_SKIP;}
+                }
+                m_length = length;
             }
 
-            virtual ~MirrorStrip() {
+            int getLength() const { return m_length;}
+            int getPending(HSLChannel channel) const { return m_pending[channel];}
+            int16_t* getValues(HSLChannel channel) { return m_values+channel*m_capacity;}
+            bool isSet(HSLChannel channel, int pos) const { return m_values[channel*m_capacity+pos] != HSL_SPAN_SKIP;}
 
+            int16_t getValue(HSLChannel channel, int pos) const { return m_values[channel*m_capacity+pos];}
+            HSLOperation getOp(HSLChannel channel, int pos) const { return decodeOp(m_ops[channel*m_capacity+pos]);}
+
+            void set(HSLChannel channel, int pos, int16_t value, HSLOperation op) {
+                int i = channel*m_capacity+pos;
+                if (m_values[i] == HSL_SPAN_SKIP) { m_pending[channel]++;}
+                m_values[i] = value;
+                m_ops[i] = encodeOp(op);
             }
 
-            void updatePosition() { 
-                
-                // int len = m_parentLength;
-                // if (m_position->hasLength()){
-                //     UnitValue uv = m_position->getLength();
-                //     LogIndent li(m_logger,"MirrorStrip.updatePosition",NEVER_LEVEL);
-                //     len = unitToPixel(uv);
-                //     m_logger->never("defined len %d  %d %3.3f",len,(int)uv.getUnit(),uv.getValue());
-                // }
-                // m_lastLed = m_offset+len-1;
-                // m_length = len/2;
-                // m_logger->never("mirror last=%d len=%d",m_lastLed,m_length);
+            void unset(HSLChannel channel, int pos) {
+                int i = channel*m_capacity+pos;
+                if (m_values[i] != HSL_SPAN_SKIP) {
+                    m_values[i] = HSL_SPAN_SKIP;
+                    m_pending[channel]--;
+                }
             }
 
-            void setHue(int16_t hue,int index, HSLOperation op) override {
-                if (!isPositionValid(index)) { 
+            void clear(HSLChannel channel) {
+                int16_t* values = getValues(channel);
+                for(int i=0;i<m_length;i++) { values[i] = HSL_SPAN_SKIP;}
+                m_pending[channel] = 0;
+            }
+
+        protected:
+            // INHERIT and UNSET do not fit in a byte
+            static uint8_t encodeOp(HSLOperation op) { return op == INHERIT ? 254 : op == UNSET ? 255 : (uint8_t)op;}
+            static HSLOperation decodeOp(uint8_t op) { return op == 254 ? INHERIT : op == 255 ? UNSET : (HSLOperation)op;}
+
+            int m_capacity;
+            int m_length;
+            int16_t* m_values;
+            uint8_t* m_ops;
+            int m_pending[3];
+    };
+
+    /* a strip that draws each LED to several places ("images") in its parent.
+     * between beginImages() and endImages() LED values are drawn once into a SegmentBuffer
+     * and each image is written to the parent as spans when the children are done.
+     * LEDs are only buffered if the images of different LEDs cannot land on the same parent LED,
+     * so the parent gets the same writes in a different order.  Any other write flushes the buffer first
+     * and is written to each image immediately.
+     */
+    class ImageStrip : public ScriptHSLStrip {
+        public:
+            ImageStrip() : ScriptHSLStrip() {
+                m_buffering = false;
+                m_segmentStart = 0;
+            }
+
+            virtual ~ImageStrip() {
+
+            }
+
+            void beginImages() {
+                m_buffering = false;
+                int length = getSegmentLength();
+                if (m_parent == NULL || length <= 0 || !hasDisjointImages()) {
                     return;
                 }
-                int tidx = translateIndex(index);
-                HSLOperation top = translateOp(op);
-                m_parent->setHue(hue,tidx,op);
-                m_parent->setHue(hue,mirrorIndex(tidx),top);
+                m_parent->getTransform(m_parentTransform);
+                m_segmentStart = m_offset+m_relativeOffset;
+                m_buffer.begin(length);
+                m_buffering = true;
+                // images past the end of a wrapping parent can be buffered if they all fit in one period
+                int first = STRIP_INDEX_LIMIT;
+                int last = -STRIP_INDEX_LIMIT;
+                for(int image=0;image<getImageCount();image++) {
+                    int a = getImageIndex(image,m_segmentStart);
+                    int b = getImageIndex(image,m_segmentStart+length-1);
+                    if (a > b) { int t = a; a = b; b = t;}
+                    if (a < first) { first = a;}
+                    if (b > last) { last = b;}
+                }
+                if (first < m_parentTransform.low || last-first >= m_parentTransform.period) {
+                    m_parentTransform.period = 0;
+                }
+            }
+
+            void endImages() {
+                flush();
+                m_buffering = false;
+            }
+
+            void setHue(int16_t hue,int index, HSLOperation op) override {
+                setValue(HSL_HUE,hue,index,op);
             }
 
             void setSaturation(int16_t saturation,int index, HSLOperation op) override {
-                if (!isPositionValid(index)) { return;}            
-                m_logger->never("ScriptHSLStrip.setSaturation op=%d",translateOp(op)); 
-                int tidx = translateIndex(index);
-                HSLOperation top = translateOp(op);
-                m_parent->setSaturation(saturation,tidx,op);
-                m_parent->setSaturation(saturation,mirrorIndex(tidx),top);
+                setValue(HSL_SATURATION,saturation,index,op);
             }
 
             void setLightness(int16_t lightness,int index, HSLOperation op) override {
-                if (!isPositionValid(index)) { return;}             
-                int tidx = translateIndex(index);
-                HSLOperation top = translateOp(op);
-                m_parent->setLightness(lightness,tidx,op);
-                m_parent->setLightness(lightness,mirrorIndex(tidx),top);
-                
+                setValue(HSL_LIGHTNESS,lightness,index,op);
             }
 
             void setRGB(const CRGB& rgb,int index, HSLOperation op) override {
-                if (!isPositionValid(index)) { return;}             
+                if (!isPositionValid(index)) { return;}            
+                int tidx = translateIndex(index);
+                int pos = getBufferPosition(tidx);
+                if (pos < 0) {
+                    flush();
+                } else {
+                    flushPosition(HSL_HUE,pos);
+                    flushPosition(HSL_SATURATION,pos);
+                    flushPosition(HSL_LIGHTNESS,pos);
+                }
+                for(int image=0;image<getImageCount();image++) {
+                    if (isImageValid(image,tidx)) {
+                        m_parent->setRGB(rgb,getImageIndex(image,tidx),getImageOp(image,op));
+                    }
+                }
+            }              
+
+            // each LED may be written to several places so spans are drawn one LED at a time
+            void setSpan(HSLChannel channel, int index, int count, int step, const int16_t* values, HSLOperation op) override {
+                setEachInSpan(channel,index,count,step,values,op);
+            }
+
+            // children's transforms stop here since each LED may be written to several places
+            void getTransform(StripTransform& transform) override {
+                transform = StripTransform();
+                transform.target = this;
+            }
+
+        protected:
+            virtual int getImageCount()=0;
+            // parent index of an image of translated index tidx
+            virtual int getImageIndex(int image, int tidx)=0;
+            // parent index change for each LED in the segment
+            virtual int getImageStep(int image) { return 1;}
+            virtual bool isImageValid(int image, int tidx) { return true;}
+            virtual HSLOperation getImageOp(int image, HSLOperation op) { return translateOp(op);}
+            // number of LEDs starting at m_offset+m_relativeOffset that can be buffered
+            virtual int getSegmentLength() { return m_length;}
+            // true if images of different LEDs in the segment never share a parent index
+            virtual bool hasDisjointImages() { return true;}
+
+            void setValue(HSLChannel channel, int16_t value, int index, HSLOperation op) {
+                if (!isPositionValid(index)) { return;}
                 int tidx = translateIndex(index);
-                HSLOperation top = translateOp(op);
-                m_parent->setRGB(rgb,tidx,op);
-                m_parent->setRGB(rgb,mirrorIndex(tidx),top);
+                int pos = getBufferPosition(tidx);
+                if (pos >= 0 && value != HSL_SPAN_SKIP) {
+                    flushPosition(channel,pos);
+                    m_buffer.set(channel,pos,value,op);
+                    return;
+                }
+                if (pos < 0) {
+                    flush();
+                } else {
+                    flushPosition(channel,pos);
+                }
+                for(int image=0;image<getImageCount();image++) {
+                    if (isImageValid(image,tidx)) {
+                        setParentValue(channel,value,getImageIndex(image,tidx),getImageOp(image,op));
+                    }
+                }
+            }
+
+            void setParentValue(HSLChannel channel, int16_t value, int index, HSLOperation op) {
+                switch(channel) {
+                    case HSL_HUE: m_parent->setHue(value,index,op); break;
+                    case HSL_SATURATION: m_parent->setSaturation(value,index,op); break;
+                    case HSL_LIGHTNESS: m_parent->setLightness(value,index,op); break;
+                }
+            }
+
+            // buffer position of tidx or -1 if it is written to the parent directly.  
+            // every image must be inside the parent's transform so it maps to its own parent LED.
+            int getBufferPosition(int tidx) {
+                if (!m_buffering) { return -1;}
+                int pos = tidx-m_segmentStart;
+                if (pos < 0 || pos >= m_buffer.getLength()) { return -1;}
+                for(int image=0;image<getImageCount();image++) {
+                    if (isImageValid(image,tidx) && !m_parentTransform.contains(m_parentTransform.wrap(getImageIndex(image,tidx)))) {
+                        return -1;
+                    }
+                }
+                return pos;
+            }
+
+            // write one buffered LED to each image before it is changed
+            void flushPosition(HSLChannel channel, int pos) {
+                if (!m_buffer.isSet(channel,pos)) { return;}
+                int tidx = m_segmentStart+pos;
+                int16_t value = m_buffer.getValue(channel,pos);
+                HSLOperation op = m_buffer.getOp(channel,pos);
+                m_buffer.unset(channel,pos);
+                for(int image=0;image<getImageCount();image++) {
+                    if (isImageValid(image,tidx)) {
+                        setParentValue(channel,value,getImageIndex(image,tidx),getImageOp(image,op));
+                    }
+                }
+            }
+
+            // write runs of buffered LEDs with the same operation to each image as spans
+            void flush() {
+                if (!m_buffering) { return;}
+                for(int c=0;c<3;c++) {
+                    HSLChannel channel = (HSLChannel)c;
+                    if (m_buffer.getPending(channel) == 0) { continue;}
+                    const int16_t* values = m_buffer.getValues(channel);
+                    int length = m_buffer.getLength();
+                    for(int image=0;image<getImageCount();image++) {
+                        int pos = 0;
+                        while(pos < length) {
+                            if (!m_buffer.isSet(channel,pos) || !isImageValid(image,m_segmentStart+pos)) {
+                                pos++;
+                                continue;
+                            }
+                            HSLOperation op = m_buffer.getOp(channel,pos);
+                            int first = pos;
+                            int last = pos;
+                            for(pos++;pos<length && isImageValid(image,m_segmentStart+pos);pos++) {
+                                if (m_buffer.isSet(channel,pos)) {
+                                    if (m_buffer.getOp(channel,pos) != op) { break;}
+                                    last = pos;
+                                }
+                            }
+                            blitSpan(channel,getImageIndex(image,m_segmentStart+first),last-first+1,
+                                getImageStep(image),values+first,getImageOp(image,op));
+                            pos = last+1;
+                        }
+                    }
+                    m_buffer.clear(channel);
+                }
+            }
+
+            // write buffered values through the parent's transform.  
+            // the span is split where it wraps past the end of the parent
+            void blitSpan(HSLChannel channel, int index, int count, int step, const int16_t* values, HSLOperation op) {
+                const StripTransform& t = m_parentTransform;
+                while(count > 0) {
+                    int start = t.wrap(index);
+                    int n;
+                    if (step > 0) {
+                        n = t.high-start+1;
+                    } else {
+                        n = index > t.high ? index-t.high : start-t.low+1;
+                    }
+                    if (n > count) { n = count;}
+                    if (t.target) {
+                        t.target->setSpan(channel,t.apply(start),n,step*t.scale,values,op);
+                    } else {
+                        t.base->setSpan(channel,t.apply(start),n,step*t.scale,values,t.resolveOp(op));
+                    }
+                    index += n*step;
+                    values += n;
+                    count -= n;
+                }
+            }
+
+            bool m_buffering;
+            int m_segmentStart;
+            StripTransform m_parentTransform;
+            SegmentBuffer m_buffer;
+    };
+
+    class MirrorStrip : public ImageStrip {
+        public:
+            MirrorStrip() : ImageStrip() {
+                m_lastLed = 0;
+            }
+
+            virtual ~MirrorStrip() {
+
+            }
+
+            void updatePosition() { 
                 
-            }   
+                // int len = m_parentLength;
+                // if (m_position->hasLength()){
+                //     UnitValue uv = m_position->getLength();
+                //     LogIndent li(m_logger,"MirrorStrip.updatePosition",NEVER_LEVEL);
+                //     len = unitToPixel(uv);
+                //     m_logger->never("defined len %d  %d %3.3f",len,(int)uv.getUnit(),uv.getValue());
+                // }
+                // m_lastLed = m_offset+len-1;
+                // m_length = len/2;
+                // m_logger->never("mirror last=%d len=%d",m_lastLed,m_length);
+            }
 
             int getParentLength() override {
                 return m_parent->getLength()/2;
             }
 
         protected:
+            int getImageCount() override { return 2;}
+            int getImageIndex(int image, int tidx) override { return image == 0 ? tidx : mirrorIndex(tidx);}
+            int getImageStep(int image) override { return image == 0 ? 1 : -1;}
+            // the original LED is drawn with the untranslated operation
+            HSLOperation getImageOp(int image, HSLOperation op) override { return image == 0 ? op : translateOp(op);}
+
+            // the mirrored LEDs must all come after the original LEDs
+            bool hasDisjointImages() override {
+                int start = m_offset+m_relativeOffset;
+                return start+m_length-1 < mirrorIndex(start+m_length-1);
+            }
+
             int mirrorIndex(int idx) {
                 return m_parent->getLength() - (idx-m_offset-m_relativeOffset);
             }
@@ -104,9 +372,9 @@ namespace DevRelief
 
     };
 
-    class CopyStrip : public ScriptHSLStrip {
+    class CopyStrip : public ImageStrip {
         public:
-            CopyStrip() : ScriptHSLStrip() {
+            CopyStrip() : ImageStrip() {
                 m_count = 0;
                 m_repeatOffset = 0;
             }
@@ -128,46 +396,11 @@ namespace DevRelief
                 }
             }
 
-
-            void setHue(int16_t hue,int index, HSLOperation op) override {
-                if (!isPositionValid(index)) { 
-                    return;
-                }
-                int tidx = translateIndex(index);
-                HSLOperation top = translateOp(op);
-                for(int i=0;i<m_count;i++) {
-                    m_parent->setHue(hue,tidx+i*m_repeatOffset,top);
-                }
-            }
-
-            void setSaturation(int16_t saturation,int index, HSLOperation op) override {
-                if (!isPositionValid(index)) { return;}            
-                int tidx = translateIndex(index);
-                HSLOperation top = translateOp(op);
-                for(int i=0;i<m_count;i++) {
-                    m_parent->setSaturation(saturation,tidx+i*m_repeatOffset,top);
-                }
-            }
-
-            void setLightness(int16_t lightness,int index, HSLOperation op) override {
-                if (!isPositionValid(index)) { return;}             
-                int tidx = translateIndex(index);
-                HSLOperation top = translateOp(op);
-                for(int i=0;i<m_count;i++) {
-                    m_parent->setLightness(lightness,tidx+i*m_repeatOffset,top);
-                }
-            }
-
-            void setRGB(const CRGB& rgb,int index, HSLOperation op) override {
-                if (!isPositionValid(index)) { return;}            
-                int tidx = translateIndex(index);
-                HSLOperation top = translateOp(op);
-                for(int i=0;i<m_count;i++) {
-                    m_parent->setRGB(rgb,tidx+i*m_repeatOffset,top);
-                }                
-            }              
-
         protected:
+            int getImageCount() override { return m_count;}
+            int getImageIndex(int image, int tidx) override { return tidx+image*m_repeatOffset;}
+            bool hasDisjointImages() override { return m_repeatOffset >= m_length;}
+
             friend class CopyElement;
 
             int m_count;
@@ -175,9 +408,9 @@ namespace DevRelief
 
     };
 
-      class RepeatStrip : public ScriptHSLStrip {
+      class RepeatStrip : public ImageStrip {
         public:
-            RepeatStrip() : ScriptHSLStrip() {
+            RepeatStrip() : ImageStrip() {
                 m_repeatLength = 0;
                 m_repeatCount = 0;
             }
@@ -193,50 +426,13 @@ namespace DevRelief
                 }
             }
 
-
-            void setHue(int16_t hue,int index, HSLOperation op) override {
-                if (!isPositionValid(index)) { 
-                    return;
-                }
-                int tidx = translateIndex(index);
-                HSLOperation top = translateOp(op);
-                for(int i=0;i<=m_repeatCount;i++) {
-                    if (tidx+i*m_repeatLength >= m_length) break;
-                    m_parent->setHue(hue,tidx+i*m_repeatLength,top);
-                }
-            }
-
-            void setSaturation(int16_t saturation,int index, HSLOperation op) override {
-                if (!isPositionValid(index)) { return;}            
-                int tidx = translateIndex(index);
-                HSLOperation top = translateOp(op);
-                for(int i=0;i<=m_repeatCount;i++) {
-                    if (tidx+i*m_repeatLength >= m_length) break;
-                    m_parent->setSaturation(saturation,tidx+i*m_repeatLength,top);
-                }
-            }
-
-            void setLightness(int16_t lightness,int index, HSLOperation op) override {
-                if (!isPositionValid(index)) { return;}             
-                int tidx = translateIndex(index);
-                HSLOperation top = translateOp(op);
-                for(int i=0;i<=m_repeatCount;i++) {
-                    if (tidx+i*m_repeatLength >= m_length) break;
-                    m_parent->setLightness(lightness,tidx+i*m_repeatLength,top);
-                }
-            }
-
-            void setRGB(const CRGB& rgb,int index, HSLOperation op) override {
-                if (!isPositionValid(index)) { return;}            
-                int tidx = translateIndex(index);
-                HSLOperation top = translateOp(op);
-                for(int i=0;i<=m_repeatCount;i++) {
-                    if (tidx+i*m_repeatLength >= m_length) break;
-                    m_parent->setRGB(rgb,tidx+i*m_repeatLength,top);
-                }                
-            }              
-
         protected:
+            int getImageCount() override { return m_repeatCount+1;}
+            int getImageIndex(int image, int tidx) override { return tidx+image*m_repeatLength;}
+            bool isImageValid(int image, int tidx) override { return tidx+image*m_repeatLength < m_length;}
+            // only the first repeat is buffered.  LEDs after it overlap later repeats
+            int getSegmentLength() override { return m_repeatLength < m_length ? m_repeatLength : m_length;}
+
             friend class CopyElement;
 
             int m_repeatCount;
@@ -285,8 +481,13 @@ namespace DevRelief
 
             virtual bool beforeDrawChildren() { 
                 m_mirrorStrip.updatePosition();
+                m_mirrorStrip.beginImages();
                 return true;
             }                
+
+            virtual void afterDrawChildren() { 
+                m_mirrorStrip.endImages();
+            }
         private:
             MirrorStrip  m_mirrorStrip;
     };
@@ -312,9 +513,14 @@ namespace DevRelief
                     m_count = m_countValue->getIntValue(getContext(),1);
                 }
                 m_copyStrip.setCount(m_count);
+                m_copyStrip.beginImages();
                 return true;
             }
 
+            virtual void afterDrawChildren() { 
+                m_copyStrip.endImages();
+            }
+
             void valuesToJson(JsonObject* json) const override {
                 StripElement::valuesToJson(json);
                 if (m_countValue) {
@@ -360,8 +566,13 @@ namespace DevRelief
                     }
                 });
                 m_repeatStrip.setRepeatLength(childrenLength);
+                m_repeatStrip.beginImages();
                 return true;
             }
+
+            virtual void afterDrawChildren() { 
+                m_repeatStrip.endImages();
+            }
            
         private:
             RepeatStrip m_repeatStrip;
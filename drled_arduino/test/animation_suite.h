@@ -0,0 +1,134 @@
+#ifndef ANIMATION_TEST_SUITE_H
+#define ANIMATION_TEST_SUITE_H
+
+
+#include "../lib/test/test_suite.h"
+#include "../script/animation.h"
+#include "../script/script_value.h"
+#include "../script/script_context.h"
+
+#if RUN_TESTS==1
+namespace DevRelief {
+
+// largest difference allowed between the ease table and the curve
+#define EASE_TABLE_ERROR 0.0001
+#define EASE_BENCHMARK_POSITIONS 3000
+
+class AnimationTestSuite : public TestSuite{
+    public:
+
+        static bool Run(ILogger* logger) {
+            AnimationTestSuite test(logger);
+            test.run();
+            return test.isSuccess();
+        }
+
+        void run() {
+            runTest("testEaseTable",[&](TestResult&r){testEaseTable(r);});
+            runTest("testEaseUpdate",[&](TestResult&r){testEaseUpdate(r);});
+            runTest("benchmarkEase",[&](TestResult&r){benchmarkEase(r);});
+        }
+
+        AnimationTestSuite(ILogger* logger) : TestSuite("Animation Tests",logger){
+
+        }
+
+    protected:
+        void testEaseTable(TestResult& result);
+        void testEaseUpdate(TestResult& result);
+        void benchmarkEase(TestResult& result);
+
+        double maxDifference(CubicBezierEase& ease) {
+            double maxDiff = 0;
+            for(int i=0;i<=EASE_BENCHMARK_POSITIONS;i++) {
+                double position = (double)i/EASE_BENCHMARK_POSITIONS;
+                double diff = fabs(ease.calculate(position)-ease.calculateFloat(position));
+                if (diff > maxDiff) {
+                    maxDiff = diff;
+                }
+            }
+            return maxDiff;
+        }
+};
+
+void AnimationTestSuite::testEaseTable(TestResult& result) {
+    double maxDiff = 0;
+    // includes values outside 0-1 that overshoot the ends
+    for(int in=-2;in<=6;in++) {
+        for(int out=-2;out<=6;out++) {
+            CubicBezierEase ease(in/4.0,out/4.0);
+            double diff = maxDifference(ease);
+            if (diff > maxDiff) {
+                maxDiff = diff;
+            }
+        }
+        yield();
+    }
+    result.assertTrue(maxDiff <= EASE_TABLE_ERROR,"ease table within error of curve");
+    CubicBezierEase ease(0.3,0.8);
+    result.assertTrue(ease.calculate(0) == 0,"ease starts at 0");
+    result.assertTrue(ease.calculate(1) == 1,"ease ends at 1");
+    result.assertTrue(ease.calculate(1.5) == ease.calculateFloat(1.5),"position past the end uses the curve");
+}
+
+void AnimationTestSuite::testEaseUpdate(TestResult& result) {
+    RootContext ctx;
+    CubicBezierEase ease(new ScriptNumberValue(0.2),new ScriptNumberValue(0.9));
+    ease.update(&ctx);
+    CubicBezierEase expected(0.2,0.9);
+    result.assertTrue(ease.calculate(0.3) == expected.calculate(0.3),"table rebuilt from script values");
+    result.assertTrue(maxDifference(ease) <= EASE_TABLE_ERROR,"updated table within error of curve");
+    ease.setValues(0.7,0.1);
+    result.assertTrue(maxDifference(ease) <= EASE_TABLE_ERROR,"table rebuilt by setValues");
+
+    CubicBezierEase lazy(0.4,0.6);
+    result.assertFalse(lazy.hasTable(),"table not built until calculated");
+    lazy.calculate(0.5);
+    result.assertTrue(lazy.hasTable(),"table built by calculate");
+
+    // values that change each frame rebuild the table once when they change
+    RootContext frameCtx;
+    CubicBezierEase perFrame(new ScriptVariableValue(true,"step",NULL),new ScriptNumberValue(0.5));
+    result.assertEqual(perFrame.getVariance(),VARIANCE_FRAME,"per frame ease");
+    frameCtx.beginStep();
+    perFrame.update(&frameCtx);
+    perFrame.calculate(0.5);
+    result.assertTrue(perFrame.hasTable(),"per frame ease has a table");
+    perFrame.update(&frameCtx);
+    result.assertTrue(perFrame.hasTable(),"same frame values keep the table");
+    frameCtx.beginStep();
+    perFrame.update(&frameCtx);
+    result.assertFalse(perFrame.hasTable(),"new frame values mark the table out of date");
+    CubicBezierEase frameExpected(2,0.5);
+    result.assertTrue(perFrame.calculate(0.3) == frameExpected.calculate(0.3),"table rebuilt for the new frame");
+
+    // values that change for each LED calculate the curve instead of building a table
+    CubicBezierEase perLED(new ScriptVariableValue(true,"led",NULL),new ScriptNumberValue(0.5));
+    result.assertEqual(perLED.getVariance(),VARIANCE_LED,"per LED ease");
+    ctx.getAnimationPositionDomain()->setPosition(3,0,10);
+    perLED.update(&ctx);
+    result.assertTrue(perLED.calculate(0.3) == perLED.calculateFloat(0.3),"per LED ease uses the curve");
+    result.assertFalse(perLED.hasTable(),"per LED ease has no table");
+}
+
+void AnimationTestSuite::benchmarkEase(TestResult& result) {
+    CubicBezierEase ease(0.3,0.8);
+    double total = 0;
+    unsigned long start = micros();
+    for(int i=0;i<EASE_BENCHMARK_POSITIONS;i++) {
+        total += ease.calculateFloat((double)i/EASE_BENCHMARK_POSITIONS);
+    }
+    unsigned long floatUsecs = micros()-start;
+    start = micros();
+    for(int i=0;i<EASE_BENCHMARK_POSITIONS;i++) {
+        total += ease.calculate((double)i/EASE_BENCHMARK_POSITIONS);
+    }
+    unsigned long tableUsecs = micros()-start;
+    m_logger->info("benchmark: %d eases. float %d usecs.  table %d usecs",EASE_BENCHMARK_POSITIONS,(int)floatUsecs,(int)tableUsecs);
+    result.assertTrue(total > 0,"benchmark calculated eases");
+}
+
+}
+#endif
+
+#endif
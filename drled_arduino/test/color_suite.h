@@ -0,0 +1,147 @@
+#ifndef COLOR_TEST_SUITE_H
+#define COLOR_TEST_SUITE_H
+
+
+#include "../lib/test/test_suite.h"
+#include "../lib/led/color.h"
+
+#if RUN_TESTS==1
+namespace DevRelief {
+
+#define COLOR_BENCHMARK_REPEAT 5
+
+class ColorTestSuite : public TestSuite{
+    public:
+
+        static bool Run(ILogger* logger) {
+            ColorTestSuite test(logger);
+            test.run();
+            return test.isSuccess();
+        }
+
+        void run() {
+            runTest("testHSLToRGBFixed",[&](TestResult&r){testHSLToRGBFixed(r);});
+            runTest("benchmarkHSLToRGB",[&](TestResult&r){benchmarkHSLToRGB(r);});
+            runTest("testRGBToHSLFixed",[&](TestResult&r){testRGBToHSLFixed(r);});
+            runTest("benchmarkRGBToHSL",[&](TestResult&r){benchmarkRGBToHSL(r);});
+        }
+
+        ColorTestSuite(ILogger* logger) : TestSuite("Color Tests",logger){
+
+        }
+
+    protected:
+        void testHSLToRGBFixed(TestResult& result);
+        void benchmarkHSLToRGB(TestResult& result);
+        void testRGBToHSLFixed(TestResult& result);
+        void benchmarkRGBToHSL(TestResult& result);
+
+        int maxDifference(const CRGB& a, const CRGB& b) {
+            int diff = abs(a.red-b.red);
+            if (abs(a.green-b.green) > diff) { diff = abs(a.green-b.green);}
+            if (abs(a.blue-b.blue) > diff) { diff = abs(a.blue-b.blue);}
+            return diff;
+        }
+
+        // hues 359 and 0 differ by 1
+        int maxDifference(const CHSL& a, const CHSL& b) {
+            int diff = abs(a.hue-b.hue);
+            if (diff > 180) { diff = 360-diff;}
+            if (abs(a.saturation-b.saturation) > diff) { diff = abs(a.saturation-b.saturation);}
+            if (abs(a.lightness-b.lightness) > diff) { diff = abs(a.lightness-b.lightness);}
+            return diff;
+        }
+};
+
+void ColorTestSuite::testHSLToRGBFixed(TestResult& result) {
+    int maxDiff = 0;
+    for(int hue=0;hue<=360;hue++) {
+        for(int saturation=0;saturation<=100;saturation+=5) {
+            for(int lightness=0;lightness<=100;lightness+=5) {
+                CHSL hsl(hue,saturation,lightness);
+                int diff = maxDifference(HSLToRGBFloat(hsl),HSLToRGBFixed(hsl));
+                if (diff > maxDiff) {
+                    maxDiff = diff;
+                }
+            }
+        }
+        yield();
+    }
+    result.assertBetween(maxDiff,0,1,"fixed point HSL within 1 of float");
+    CRGB white = HSLToRGBFixed(CHSL(0,0,100));
+    result.assertEqual(white.red,255,"white");
+    CRGB red = HSLToRGBFixed(CHSL(0,100,50));
+    result.assertEqual(red.red,255,"red");
+    result.assertEqual(red.blue,0,"red has no blue");
+}
+
+void ColorTestSuite::benchmarkHSLToRGB(TestResult& result) {
+    int total = 0;
+    unsigned long start = micros();
+    for(int repeat=0;repeat<COLOR_BENCHMARK_REPEAT;repeat++) {
+        for(int hue=0;hue<360;hue++) {
+            total += HSLToRGBFloat(CHSL(hue,100,40+(total&15))).red;
+        }
+    }
+    unsigned long floatUsecs = micros()-start;
+    start = micros();
+    for(int repeat=0;repeat<COLOR_BENCHMARK_REPEAT;repeat++) {
+        for(int hue=0;hue<360;hue++) {
+            total += HSLToRGBFixed(CHSL(hue,100,40+(total&15))).red;
+        }
+    }
+    unsigned long fixedUsecs = micros()-start;
+    m_logger->info("benchmark: %d conversions. float %d usecs.  fixed %d usecs",COLOR_BENCHMARK_REPEAT*360,(int)floatUsecs,(int)fixedUsecs);
+    result.assertTrue(total > 0,"benchmark converted colors");
+}
+
+void ColorTestSuite::testRGBToHSLFixed(TestResult& result) {
+    int maxDiff = 0;
+    for(int red=0;red<=255;red+=5) {
+        for(int green=0;green<=255;green+=5) {
+            for(int blue=0;blue<=255;blue+=5) {
+                CRGB rgb(red,green,blue);
+                int diff = maxDifference(RGBToHSLFloat(rgb),RGBToHSLFixed(rgb));
+                if (diff > maxDiff) {
+                    maxDiff = diff;
+                }
+            }
+        }
+        yield();
+    }
+    result.assertBetween(maxDiff,0,1,"fixed point RGB within 1 of float");
+    CHSL white = RGBToHSLFixed(CRGB(255,255,255));
+    result.assertEqual(white.lightness,100,"white");
+    result.assertEqual(white.saturation,0,"white has no saturation");
+    CHSL blue = RGBToHSLFixed(CRGB(0,0,255));
+    result.assertEqual(blue.hue,240,"blue");
+    result.assertEqual(blue.saturation,100,"blue saturation");
+    result.assertEqual(blue.lightness,50,"blue lightness");
+    CHSL magenta = RGBToHSLFixed(CRGB(255,0,128));
+    result.assertEqual(magenta.hue,329,"hue past blue wraps toward red");
+}
+
+void ColorTestSuite::benchmarkRGBToHSL(TestResult& result) {
+    int total = 0;
+    unsigned long start = micros();
+    for(int repeat=0;repeat<COLOR_BENCHMARK_REPEAT;repeat++) {
+        for(int i=0;i<360;i++) {
+            total += RGBToHSLFloat(CRGB(i,(i*7)&255,(total&127))).hue;
+        }
+    }
+    unsigned long floatUsecs = micros()-start;
+    start = micros();
+    for(int repeat=0;repeat<COLOR_BENCHMARK_REPEAT;repeat++) {
+        for(int i=0;i<360;i++) {
+            total += RGBToHSLFixed(CRGB(i,(i*7)&255,(total&127))).hue;
+        }
+    }
+    unsigned long fixedUsecs = micros()-start;
+    m_logger->info("benchmark: %d conversions. float %d usecs.  fixed %d usecs",COLOR_BENCHMARK_REPEAT*360,(int)floatUsecs,(int)fixedUsecs);
+    result.assertTrue(total > 0,"benchmark converted colors");
+}
+
+}
+#endif
+
+#endif
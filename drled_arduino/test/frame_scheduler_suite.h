@@ -0,0 +1,80 @@
+#ifndef FRAME_SCHEDULER_TEST_SUITE_H
+#define FRAME_SCHEDULER_TEST_SUITE_H
+
+
+#include "../lib/test/test_suite.h"
+#include "../script/frame_scheduler.h"
+
+#if RUN_TESTS==1
+namespace DevRelief {
+
+class FrameSchedulerTestSuite : public TestSuite{
+    public:
+
+        static bool Run(ILogger* logger) {
+            FrameSchedulerTestSuite test(logger);
+            test.run();
+            return test.isSuccess();
+        }
+
+        void run() {
+            runTest("testDeadlines",[&](TestResult&r){testDeadlines(r);});
+            runTest("testFrameStats",[&](TestResult&r){testFrameStats(r);});
+        }
+
+        FrameSchedulerTestSuite(ILogger* logger) : TestSuite("FrameScheduler Tests",logger){
+
+        }
+
+    protected:
+        void testDeadlines(TestResult& result);
+        void testFrameStats(TestResult& result);
+};
+
+void FrameSchedulerTestSuite::testDeadlines(TestResult& result) {
+    FrameScheduler scheduler;
+    result.assertTrue(scheduler.isDue(1000,50),"first frame is due");
+    result.assertFalse(scheduler.isDue(1049,50),"too soon");
+    // a frame that starts late does not move later deadlines
+    result.assertTrue(scheduler.isDue(1060,50),"late frame is due");
+    result.assertFalse(scheduler.isDue(1099,50),"next deadline is 1100");
+    result.assertTrue(scheduler.isDue(1100,50),"on time frame");
+    // 1150, 1200 and 1250 were missed
+    result.assertTrue(scheduler.isDue(1310,50),"frame after missed deadlines");
+    result.assertEqual((int)scheduler.getStats().getDroppedFrames(),3,"dropped frames");
+    result.assertFalse(scheduler.isDue(1349,50),"next deadline is 1350");
+    result.assertTrue(scheduler.isDue(1350,50),"back on schedule");
+    result.assertTrue(scheduler.isDue(1350,20),"frequency change starts a new timeline");
+    result.assertFalse(scheduler.isDue(1369,20),"new frequency");
+    result.assertTrue(scheduler.isDue(1369,0),"no frequency draws every call");
+    result.assertTrue(scheduler.isDue(1369,0),"no frequency draws again");
+    result.assertEqual((int)scheduler.getStats().getDroppedFrames(),3,"no frequency drops nothing");
+    result.assertTrue(scheduler.isDue(1400,20),"frequency after none starts a new timeline");
+    result.assertFalse(scheduler.isDue(1419,20),"deadline after none");
+}
+
+void FrameSchedulerTestSuite::testFrameStats(TestResult& result) {
+    FrameStats stats;
+    result.assertEqual((int)stats.getP99Usecs(),0,"no frames");
+    for(int i=1;i<=200;i++) {
+        stats.addFrame(i*10,i>195);
+    }
+    result.assertEqual((int)stats.getFrames(),200,"frames");
+    result.assertEqual((int)stats.getMinUsecs(),10,"min");
+    result.assertEqual((int)stats.getMaxUsecs(),2000,"max");
+    result.assertEqual((int)stats.getAverageUsecs(),1005,"average");
+    result.assertEqual((int)stats.getLateFrames(),5,"late frames");
+    // p99 of the last FRAME_TIME_SAMPLES frames (730..2000)
+    result.assertEqual((int)stats.getP99Usecs(),1990,"p99");
+    // slow frames are not capped at 16 bits
+    for(int i=0;i<FRAME_TIME_SAMPLES;i++) {
+        stats.addFrame(70000+i,false);
+    }
+    result.assertEqual((int)stats.getP99Usecs(),70000+FRAME_TIME_SAMPLES-2,"p99 over 65535");
+    result.assertTrue(stats.getP99Usecs() <= stats.getMaxUsecs(),"p99 not above max");
+}
+
+}
+#endif
+
+#endif
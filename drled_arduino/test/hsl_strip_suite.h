@@ -0,0 +1,411 @@
+#ifndef HSL_STRIP_TEST_SUITE_H
+#define HSL_STRIP_TEST_SUITE_H
+
+
+#include "../lib/test/test_suite.h"
+#include "../lib/led/led_strip.h"
+
+#if RUN_TESTS==1
+namespace DevRelief {
+
+// remembers colors in memory instead of sending them to LEDs
+class MemoryLedStrip : public DRLedStrip {
+    public:
+        MemoryLedStrip(int count) : DRLedStrip(30) {
+            m_count = count;
+            m_colors = new CRGB[count];
+            m_setCount = 0;
+        }
+
+        virtual ~MemoryLedStrip() {
+            delete [] m_colors;
+        }
+
+        void clear() override {}
+        void setBrightness(uint16_t brightness) override {}
+        void setColor(uint16_t index, const CRGB& color) override {
+            m_colors[index] = color;
+            m_setCount++;
+        }
+        int getLEDCount() override { return m_count;}
+        void show() override {}
+        CompoundLedStrip* getCompoundLedStrip() override { return NULL;}
+
+        const CRGB& getColor(int index) { return m_colors[index];}
+        int getSetCount() { return m_setCount;}
+        void resetSetCount() { m_setCount = 0;}
+    private:
+        int m_count;
+        int m_setCount;
+        CRGB* m_colors;
+};
+
+// keeps pixels in memory and counts frames sent
+class MemoryLedOutput : public ILedOutput {
+    public:
+        MemoryLedOutput(int count) {
+            m_count = count;
+            m_pixels = new uint8_t[count*3];
+            memset(m_pixels,0,count*3);
+            m_shown = 0;
+        }
+
+        virtual ~MemoryLedOutput() {
+            delete [] m_pixels;
+        }
+
+        uint16_t numPixels() override { return m_count;}
+        int getPin() override { return 0;}
+        void clear() override { memset(m_pixels,0,m_count*3);}
+        void setPixel(uint16_t index, uint8_t red, uint8_t green, uint8_t blue) override {
+            m_pixels[index*3] = red;
+            m_pixels[index*3+1] = green;
+            m_pixels[index*3+2] = blue;
+        }
+        const uint8_t* getPixels() override { return m_pixels;}
+        uint16_t getPixelBytes() override { return m_count*3;}
+        void show() override { m_shown++;}
+        unsigned long getTransmitUsecs() override { return 100;}
+
+        int getShown() { return m_shown;}
+    private:
+        int m_count;
+        int m_shown;
+        uint8_t* m_pixels;
+};
+
+// LED counts for the span blend test and benchmark
+#define BLEND_TEST_LEDS 60
+#define BLEND_BENCHMARK_LEDS 600
+#define BLEND_BENCHMARK_FRAMES 20
+
+class HSLStripTestSuite : public TestSuite{
+    public:
+
+        static bool Run(ILogger* logger) {
+            HSLStripTestSuite test(logger);
+            test.run();
+            return test.isSuccess();
+        }
+
+        void run() {
+            runTest("testDirtyRange",[&](TestResult&r){testDirtyRange(r);});
+            runTest("testFrameStore",[&](TestResult&r){testFrameStore(r);});
+            runTest("testCompoundStrip",[&](TestResult&r){testCompoundStrip(r);});
+            runTest("testUnchangedFrames",[&](TestResult&r){testUnchangedFrames(r);});
+            runTest("testBrightnessTable",[&](TestResult&r){testBrightnessTable(r);});
+            runTest("testBlendSpans",[&](TestResult&r){testBlendSpans(r);});
+            runTest("testBlendBytes",[&](TestResult&r){testBlendBytes(r);});
+            runTest("benchmarkBlend",[&](TestResult&r){benchmarkBlend(r);});
+        }
+
+        HSLStripTestSuite(ILogger* logger) : TestSuite("HSLStrip Tests",logger){
+
+        }
+
+    protected:
+        void testDirtyRange(TestResult& result);
+        void testFrameStore(TestResult& result);
+        void testCompoundStrip(TestResult& result);
+        void testUnchangedFrames(TestResult& result);
+        void testBrightnessTable(TestResult& result);
+        void testBlendSpans(TestResult& result);
+        void testBlendBytes(TestResult& result);
+
+        // number of LEDs where the 4 byte blend differs from the scalar blend.  
+        // every current value [-1,100] is paired with every operand [-2,102]
+        template<class Blend>
+        int blendBytesDifferences() {
+            const int count = 105;
+            int16_t operands[count];
+            int8_t scalar[count];
+            int8_t packed[count+1];
+            int differences = 0;
+            for(int i=0;i<count;i++) {
+                operands[i] = i-2;
+            }
+            for(int c=0;c<102;c++) {
+                for(int i=0;i<count;i++) {
+                    scalar[i] = (c+i*37)%102-1;
+                    packed[i+(c&1)] = scalar[i];
+                    scalar[i] = blendByte<Blend>(scalar[i],operands[i],50);
+                }
+                // odd rows start off a 4 byte boundary
+                blendBytes<Blend>(packed+(c&1),count,operands,50);
+                for(int i=0;i<count;i++) {
+                    if (packed[i+(c&1)] != scalar[i]) { differences++;}
+                }
+            }
+            return differences;
+        }
+        void benchmarkBlend(TestResult& result);
+
+        // some LEDs left unset and a mix of hue, saturation and lightness values
+        void fillBlendStrip(HSLStrip& strip) {
+            strip.clear();
+            for(int i=0;i<BLEND_TEST_LEDS;i+=3) {
+                strip.setHue(i,(i*37)%360);
+                strip.setSaturation(i+1,(i*7)%101);
+                strip.setLightness(i,(i*13)%101);
+            }
+        }
+};
+
+
+void HSLStripTestSuite::testDirtyRange(TestResult& result) {
+    MemoryLedStrip* memory = new MemoryLedStrip(100);
+    HSLStrip strip(memory);
+
+    strip.clear();
+    for(int i=0;i<100;i++) {
+        strip.setHue(i,120);
+    }
+    strip.show();
+    result.assertEqual(strip.getPixelsConverted(),100,"first frame converts all LEDs");
+
+    strip.clear();
+    for(int i=0;i<100;i++) {
+        strip.setHue(i,120);
+    }
+    strip.setHue(10,240);
+    strip.show();
+    result.assertEqual(strip.getPixelsConverted(),1,"one LED changed");
+    result.assertEqual(memory->getColor(10).blue,255,"changed LED is blue");
+
+    strip.clear();
+    strip.setHue(20,0);
+    strip.show();
+    result.assertEqual(strip.getPixelsConverted(),100,"cleared LEDs are converted");
+    result.assertEqual(memory->getColor(50).green,0,"cleared LED is off");
+
+    strip.clear();
+    strip.setHue(20,0);
+    memory->resetSetCount();
+    strip.show();
+    result.assertEqual(strip.getPixelsConverted(),0,"nothing changed");
+    result.assertEqual(memory->getSetCount(),0,"no colors set");
+
+    strip.invalidate();
+    strip.clear();
+    strip.setHue(20,0);
+    strip.show();
+    result.assertEqual(strip.getPixelsConverted(),100,"invalidate converts all LEDs");
+}
+
+void HSLStripTestSuite::testFrameStore(TestResult& result) {
+    HSLFrameStore frames;
+    frames.allocate(10);
+    result.assertEqual(frames.getCount(),10,"allocated 10 LEDs");
+    result.assertEqual(frames.getFrontHue()[9],HUE_UNSET,"hue starts unset");
+    result.assertEqual(frames.getBackLightness()[9],-1,"lightness starts unset");
+    frames.getFrontHue()[3] = 200;
+    frames.getFrontSaturation()[3] = 50;
+    frames.swap();
+    result.assertEqual(frames.getBackHue()[3],200,"swap keeps previous hue");
+    result.assertEqual(frames.getBackSaturation()[3],50,"swap keeps previous saturation");
+    frames.getFrontHue()[3] = 100;
+    frames.clearFront();
+    result.assertEqual(frames.getFrontHue()[3],HUE_UNSET,"clear front hue");
+    result.assertEqual(frames.getBackHue()[3],200,"clear leaves back frame");
+
+    MemoryLedStrip* memory = new MemoryLedStrip(20);
+    HSLStrip strip(memory);
+    strip.allocateFrames();
+    strip.clear();
+    strip.setHue(5,120);
+    strip.show();
+    strip.setHue(6,120);
+    strip.show();
+    result.assertEqual(strip.getPixelsConverted(),20,"show() without clear() converts all LEDs");
+    strip.clear();
+    strip.setHue(5,120);
+    strip.setHue(6,120);
+    strip.show();
+    result.assertEqual(strip.getPixelsConverted(),0,"same frame after clear()");
+}
+
+void HSLStripTestSuite::testCompoundStrip(TestResult& result) {
+    CompoundLedStrip compound(30);
+    MemoryLedStrip* strips[6];
+    for(int i=0;i<6;i++) {
+        strips[i] = new MemoryLedStrip(10+i);
+        result.assertTrue(compound.add(strips[i]),"strip added");
+    }
+    result.assertFalse(compound.add(NULL),"NULL strip rejected");
+    result.assertEqual(compound.getStripCount(),6,"more than 4 strips");
+    result.assertEqual(compound.getLEDCount(),75,"LED count");
+    compound.setColor(0,CRGB(1,0,0));
+    compound.setColor(10,CRGB(2,0,0));
+    compound.setColor(74,CRGB(3,0,0));
+    compound.setColor(75,CRGB(4,0,0));
+    result.assertEqual(strips[0]->getColor(0).red,1,"first LED");
+    result.assertEqual(strips[1]->getColor(0).red,2,"second strip first LED");
+    result.assertEqual(strips[5]->getColor(14).red,3,"last LED");
+    result.assertEqual(strips[5]->getSetCount(),1,"index past the end is ignored");
+    result.assertTrue(compound.getStripNumber(6) == NULL,"no strip 6");
+    result.assertEqual(compound.getLEDCount(),75,"rejected strip leaves the table");
+}
+
+void HSLStripTestSuite::testUnchangedFrames(TestResult& result) {
+    MemoryLedOutput* output = new MemoryLedOutput(10);
+    OutputLedStrip strip(output,30);
+    strip.setColor(2,CRGB(100,0,0));
+    strip.show();
+    result.assertEqual(output->getShown(),1,"first frame sent");
+    strip.show();
+    result.assertEqual(output->getShown(),1,"nothing written");
+    result.assertEqual((int)strip.getTransmitUsecs(),0,"no transmit time when skipped");
+    strip.clear();
+    strip.setColor(2,CRGB(100,0,0));
+    strip.show();
+    result.assertEqual(output->getShown(),1,"same pixels redrawn");
+    strip.setColor(3,CRGB(0,100,0));
+    strip.show();
+    result.assertEqual(output->getShown(),2,"changed frame sent");
+    strip.resend();
+    strip.show();
+    result.assertEqual(output->getShown(),3,"resend");
+    result.assertEqual((int)strip.getSentFrames(),3,"sent frames");
+    result.assertEqual((int)strip.getSkippedFrames(),2,"skipped frames");
+
+    // these frames have the same FNV-1a hash
+    MemoryLedOutput* collisionOutput = new MemoryLedOutput(2);
+    OutputLedStrip collision(collisionOutput,30);
+    collision.setBrightness(255);
+    collision.setColor(0,CRGB(190,97,33));
+    collision.setColor(1,CRGB(45,37,148));
+    collision.show();
+    collision.setColor(0,CRGB(148,183,150));
+    collision.setColor(1,CRGB(198,112,209));
+    collision.show();
+    result.assertEqual(collisionOutput->getShown(),2,"frame with the same hash sent");
+
+    // compound and altered strips pass resend() to their outputs
+    MemoryLedOutput* reversedOutput = new MemoryLedOutput(10);
+    CompoundLedStrip compound(30);
+    compound.add(new ReverseStrip(new OutputLedStrip(reversedOutput,30)));
+    compound.show();
+    compound.show();
+    result.assertEqual(reversedOutput->getShown(),1,"compound skips unchanged frame");
+    compound.resend();
+    compound.show();
+    result.assertEqual(reversedOutput->getShown(),2,"compound resend");
+}
+
+// linear levels must match Adafruit_NeoPixel's brightness scaling
+void HSLStripTestSuite::testBrightnessTable(TestResult& result) {
+    BrightnessTable table;
+    result.assertEqual(table.level(200),200,"full brightness");
+    result.assertTrue(table.set(40,1),"new brightness");
+    result.assertFalse(table.set(40,1),"same brightness");
+    bool same = true;
+    for(int c=0;c<256;c++) {
+        if (table.level(c) != ((c*41)>>8)) { same = false;}
+    }
+    result.assertTrue(same,"Adafruit scaling");
+    table.set(255,2);
+    result.assertEqual(table.level(128),64,"gamma 2");
+    result.assertEqual(table.level(255),255,"gamma top");
+    result.assertEqual(table.level(0),0,"gamma bottom");
+    table.set(255,0);
+    result.assertEqual(table.level(0),0,"gamma 0 is linear at black");
+    result.assertEqual(table.level(128),128,"gamma 0 is linear");
+    table.set(255,-2);
+    result.assertEqual(table.level(0),0,"negative gamma is linear at black");
+    result.assertEqual(table.level(128),128,"negative gamma is linear");
+    table.set(255,1000);
+    result.assertEqual(table.level(200),0,"large gamma is dark");
+    result.assertEqual(table.level(255),255,"large gamma top");
+}
+
+// spans must give the same colors as writing each LED with performOperation()
+void HSLStripTestSuite::testBlendSpans(TestResult& result) {
+    HSLOperation ops[] = {REPLACE,ADD,SUBTRACT,AVERAGE,MIN,MAX};
+    int16_t values[BLEND_TEST_LEDS+10];
+    for(int i=0;i<BLEND_TEST_LEDS+10;i++) {
+        // includes skipped, out of range and past 360 values
+        values[i] = (i%11==0) ? HSL_SPAN_SKIP : (i*53)%420-20;
+    }
+    MemoryLedStrip* eachMemory = new MemoryLedStrip(BLEND_TEST_LEDS);
+    MemoryLedStrip* spanMemory = new MemoryLedStrip(BLEND_TEST_LEDS);
+    HSLStrip each(eachMemory);
+    HSLStrip span(spanMemory);
+    for(int o=0;o<6;o++) {
+        for(int c=0;c<3;c++) {
+            for(int step=-1;step<=1;step+=2) {
+                HSLChannel channel = (HSLChannel)c;
+                fillBlendStrip(each);
+                fillBlendStrip(span);
+                // starts 5 LEDs before one end of the strip and ends 5 after the other
+                int first = step > 0 ? -5 : BLEND_TEST_LEDS+4;
+                int index = first;
+                for(int i=0;i<BLEND_TEST_LEDS+10;i++,index+=step) {
+                    if (values[i] == HSL_SPAN_SKIP) { continue;}
+                    switch(channel) {
+                        case HSL_HUE: each.setHue(index,values[i],ops[o]); break;
+                        case HSL_SATURATION: each.setSaturation(index,values[i],ops[o]); break;
+                        case HSL_LIGHTNESS: each.setLightness(index,values[i],ops[o]); break;
+                    }
+                }
+                span.setSpan(channel,first,BLEND_TEST_LEDS+10,step,values,ops[o]);
+                each.show();
+                span.show();
+                int differences = 0;
+                for(int i=0;i<BLEND_TEST_LEDS;i++) {
+                    const CRGB& a = eachMemory->getColor(i);
+                    const CRGB& b = spanMemory->getColor(i);
+                    if (a.red != b.red || a.green != b.green || a.blue != b.blue) { differences++;}
+                }
+                result.assertEqual(differences,0,HSLOpToText(ops[o]));
+            }
+        }
+    }
+}
+
+void HSLStripTestSuite::testBlendBytes(TestResult& result) {
+    result.assertEqual(blendBytesDifferences<BlendReplace>(),0,"replace");
+    result.assertEqual(blendBytesDifferences<BlendAdd>(),0,"add");
+    result.assertEqual(blendBytesDifferences<BlendSubtract>(),0,"subtract");
+    result.assertEqual(blendBytesDifferences<BlendAverage>(),0,"average");
+    result.assertEqual(blendBytesDifferences<BlendMin>(),0,"min");
+    result.assertEqual(blendBytesDifferences<BlendMax>(),0,"max");
+    // bytes are 0>=0, 0x64>=0x63, 0x32<0x33, 0>=0
+    result.assertTrue(swarGreaterEqual(0x00326400u,0x00336300u) == 0xFF00FFFFu,"byte compare");
+}
+
+void HSLStripTestSuite::benchmarkBlend(TestResult& result) {
+    HSLOperation ops[] = {REPLACE,ADD,AVERAGE,MAX};
+    int16_t values[BLEND_BENCHMARK_LEDS];
+    for(int i=0;i<BLEND_BENCHMARK_LEDS;i++) {
+        values[i] = (i*7)%100;
+    }
+    HSLStrip strip(new MemoryLedStrip(BLEND_BENCHMARK_LEDS));
+    strip.clear();
+    int count = BLEND_BENCHMARK_LEDS*BLEND_BENCHMARK_FRAMES*3;
+    for(int o=0;o<4;o++) {
+        HSLOperation op = ops[o];
+        unsigned long start = micros();
+        for(int frame=0;frame<BLEND_BENCHMARK_FRAMES;frame++) {
+            for(int i=0;i<BLEND_BENCHMARK_LEDS;i++) {
+                strip.setHue(i,values[i],op);
+                strip.setSaturation(i,values[i],op);
+                strip.setLightness(i,values[i],op);
+            }
+        }
+        unsigned long eachUsecs = micros()-start;
+        start = micros();
+        for(int frame=0;frame<BLEND_BENCHMARK_FRAMES;frame++) {
+            strip.setSpan(HSL_HUE,0,BLEND_BENCHMARK_LEDS,1,values,op);
+            strip.setSpan(HSL_SATURATION,0,BLEND_BENCHMARK_LEDS,1,values,op);
+            strip.setSpan(HSL_LIGHTNESS,0,BLEND_BENCHMARK_LEDS,1,values,op);
+        }
+        unsigned long spanUsecs = micros()-start;
+        m_logger->info("benchmark %s: %d writes.  per LED %d usecs, spans %d usecs",HSLOpToText(op),count,(int)eachUsecs,(int)spanUsecs);
+    }
+    result.assertTrue(strip.getCount() == BLEND_BENCHMARK_LEDS,"benchmark strip");
+}
+
+}
+#endif
+
+#endif
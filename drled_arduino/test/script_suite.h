@@ -5,6 +5,8 @@
 #include "../lib/test/test_suite.h"
 #include "../script/data_loader.h"
 #include "../script/script.h"
+#include "../script/executor.h"
+#include "./hsl_strip_suite.h"
 
 #if RUN_TESTS==1
 namespace DevRelief {
@@ -21,6 +23,109 @@ const char *HSL_SIMPLE_SCRIPT = R"script(
         }        
     )script";    
 
+const char *COPY_IMAGES_SCRIPT = R"script(
+        {
+            "name": "copy",
+            "elements": [
+            {
+                "type": "copy",
+                "count": 4,
+                "elements": [
+                    { "type": "hsl", "hue": {"pattern": [10,20,30,40,50]} }
+                ]
+            }
+            ]
+        }        
+    )script";    
+
+const char *MIRROR_IMAGES_SCRIPT = R"script(
+        {
+            "name": "mirror",
+            "elements": [
+            {
+                "type": "mirror",
+                "elements": [
+                    { "type": "hsl", "hue": {"pattern": [10,20,30,40,50]} }
+                ]
+            }
+            ]
+        }        
+    )script";    
+
+const char *RGB_REPLACE_SCRIPT = R"script(
+        {
+            "name": "rgb",
+            "elements": [
+            { "type": "values", "x": 10 },
+            { "type": "rgb", "red": 200 },
+            {
+                "type": "mirror",
+                "elements": [
+                    { "type": "rgb", "blue": 100, "op": "replace" }
+                ]
+            }
+            ]
+        }        
+    )script";    
+
+const char *RGB_ADD_SCRIPT = R"script(
+        {
+            "name": "rgbadd",
+            "elements": [
+            { "type": "rgb", "red": 200 },
+            {
+                "type": "segment",
+                "elements": [
+                    { "type": "rgb", "blue": 100, "op": "add" }
+                ]
+            }
+            ]
+        }        
+    )script";    
+
+const char *RGB_MIXED_SCRIPT = R"script(
+        {
+            "name": "mixed",
+            "elements": [
+            { "type": "rgb", "red": 200 },
+            { "type": "hsl", "hue": 240, "saturation": 100, "lightness": 50, "length": 5 }
+            ]
+        }        
+    )script";    
+
+// LEDs in the executor tests
+#define EXECUTOR_TEST_LEDS 20
+#define EXECUTOR_TEST_PINS 4
+
+// remembers the hue written to each LED
+class HueRecorderStrip : public IHSLStrip {
+    public:
+        HueRecorderStrip() {
+            for(int i=0;i<20;i++) { m_hue[i] = -1;}
+        }
+
+        void setHue(int index, int16_t hue, HSLOperation op=REPLACE) override { 
+            if (index >= 0 && index < 20) { m_hue[index] = hue;}
+        }
+        void setSaturation(int index, int16_t saturation, HSLOperation op=REPLACE) override {}
+        void setLightness(int index, int16_t lightness, HSLOperation op=REPLACE) override {}
+        void setRGB(int index, const CRGB& rgb, HSLOperation op=REPLACE) override {}
+        void setSpan(HSLChannel channel, int index, int count, int step, const int16_t* values, HSLOperation op=REPLACE) override {
+            for(int i=0;i<count;i++,index+=step) {
+                if (channel == HSL_HUE && values[i] != HSL_SPAN_SKIP) { setHue(index,values[i],op);}
+            }
+        }
+        int getCount() override { return 20;}
+        int getStart() override { return 0;}
+        void clear() override {}
+        void show() override {}
+        int getPixelsPerMeter() override { return 30;}
+
+        int16_t getHue(int index) { return m_hue[index];}
+    private:
+        int16_t m_hue[20];
+};
+
 class DummyStrip : public HSLFilter {
     public:
         DummyStrip(): HSLFilter(NULL) {}
@@ -29,6 +134,35 @@ class DummyStrip : public HSLFilter {
         int getPixelsPerMeter() override { return 30;}
 };
 
+// outputs for the executor's strips are kept in memory
+// failPin has no output so its strip is not added
+class MemoryOutputFactory : public ILedOutputFactory {
+    public:
+        MemoryOutputFactory(int failPin=-1) { 
+            m_output = NULL;
+            m_failPin = failPin;
+            memset(m_pinOutputs,0,sizeof(m_pinOutputs));
+        }
+
+        ILedOutput* create(int pin, uint16_t ledCount, neoPixelType pixelType) override {
+            if (pin == m_failPin) {
+                return NULL;
+            }
+            m_output = new MemoryLedOutput(ledCount);
+            if (pin >= 0 && pin < EXECUTOR_TEST_PINS) {
+                m_pinOutputs[pin] = m_output;
+            }
+            return m_output;
+        }
+
+        MemoryLedOutput* getOutput() { return m_output;}
+        MemoryLedOutput* getOutput(int pin) { return m_pinOutputs[pin];}
+    private:
+        MemoryLedOutput* m_output;
+        MemoryLedOutput* m_pinOutputs[EXECUTOR_TEST_PINS];
+        int m_failPin;
+};
+
 class ScriptTestSuite : public TestSuite{
     public:
 
@@ -40,6 +174,12 @@ class ScriptTestSuite : public TestSuite{
 
         void run() {
             runTest("scriptLifecycle",[&](TestResult&r){scriptLifecycle(r);});
+            runTest("stripTransform",[&](TestResult&r){stripTransform(r);});
+            runTest("stripImages",[&](TestResult&r){stripImages(r);});
+            runTest("rgbDirect",[&](TestResult&r){rgbDirect(r);});
+            runTest("rgbFallback",[&](TestResult&r){rgbFallback(r);});
+            runTest("executorResend",[&](TestResult&r){executorResend(r);});
+            runTest("executorSkippedStrip",[&](TestResult&r){executorSkippedStrip(r);});
         }
 
         ScriptTestSuite(ILogger* logger) : TestSuite("Script Tests",logger){
@@ -50,6 +190,12 @@ class ScriptTestSuite : public TestSuite{
 
 
     void scriptLifecycle(TestResult& result);
+    void stripTransform(TestResult& result);
+    void stripImages(TestResult& result);
+    void rgbDirect(TestResult& result);
+    void rgbFallback(TestResult& result);
+    void executorResend(TestResult& result);
+    void executorSkippedStrip(TestResult& result);
 };
 
 
@@ -82,6 +228,143 @@ void ScriptTestSuite::scriptLifecycle(TestResult& result) {
 }
 
 
+void ScriptTestSuite::stripTransform(TestResult& result) {
+    StripTransform root;
+    root.low = 0;
+    root.high = 99;
+    // child at offset 10, 20 LEDs
+    StripTransform child;
+    child.compose(1,10,0,19,root);
+    result.assertEqual(child.apply(0),10,"child first LED");
+    result.assertTrue(child.contains(19),"child last LED");
+    result.assertFalse(child.contains(20),"past the child");
+    // reversed grandchild with 5 LEDs at child offset 2
+    StripTransform grandchild;
+    grandchild.compose(-1,6,0,4,child);
+    result.assertEqual(grandchild.apply(0),16,"reversed first LED");
+    result.assertEqual(grandchild.apply(4),12,"reversed last LED");
+    result.assertEqual(grandchild.scale,-1,"reversed scale");
+    // unclipped strip that runs off the end of the root
+    StripTransform offEnd;
+    offEnd.compose(1,95,-STRIP_INDEX_LIMIT,STRIP_INDEX_LIMIT,root);
+    result.assertTrue(offEnd.contains(4),"last root LED");
+    result.assertFalse(offEnd.contains(5),"past the root");
+    result.assertFalse(offEnd.contains(-96),"before the root");
+}
+
+void ScriptTestSuite::stripImages(TestResult& result) {
+    ScriptDataLoader loader;
+    HueRecorderStrip copyStrip;
+    Script* script = loader.parse(COPY_IMAGES_SCRIPT);
+    script->begin(&copyStrip,NULL);
+    script->step();
+    result.assertEqual(copyStrip.getHue(0),10,"first LED");
+    for(int i=0;i<5;i++) {
+        result.assertEqual(copyStrip.getHue(i+5),copyStrip.getHue(i),"second copy");
+        result.assertEqual(copyStrip.getHue(i+15),copyStrip.getHue(i),"last copy");
+    }
+    script->destroy();
+
+    HueRecorderStrip mirrorStrip;
+    script = loader.parse(MIRROR_IMAGES_SCRIPT);
+    script->begin(&mirrorStrip,NULL);
+    script->step();
+    for(int i=1;i<10;i++) {
+        result.assertEqual(mirrorStrip.getHue(20-i),mirrorStrip.getHue(i),"mirrored LED");
+    }
+    result.assertEqual(mirrorStrip.getHue(19),20,"mirror of second LED");
+    script->destroy();
+}
+
+void ScriptTestSuite::rgbDirect(TestResult& result) {
+    ScriptDataLoader loader;
+    Script* script = loader.parse(RGB_REPLACE_SCRIPT);
+    result.assertTrue(script->isRGBDirect(),"rgb replace script");
+    script->destroy();
+
+    script = loader.parse(RGB_ADD_SCRIPT);
+    result.assertFalse(script->isRGBDirect(),"rgb add script");
+    script->destroy();
+
+    script = loader.parse(HSL_SIMPLE_SCRIPT);
+    result.assertFalse(script->isRGBDirect(),"hsl script");
+    script->destroy();
+
+    script = loader.parse(RGB_MIXED_SCRIPT);
+    result.assertFalse(script->isRGBDirect(),"rgb and hsl script");
+    script->destroy();
+}
+
+// a script with HSL elements must be drawn to the HSL frame or its HSL LEDs are lost
+void ScriptTestSuite::rgbFallback(TestResult& result) {
+    ScriptDataLoader loader;
+    MemoryOutputFactory factory;
+    Config config;
+    config.addPin(1,EXECUTOR_TEST_LEDS);
+    // the executor reads pin brightness from the global config
+    Config* appConfig = Config::getInstance();
+    Config::setInstance(&config);
+    ScriptExecutor* executor = new ScriptExecutor();
+    executor->setOutputFactory(&factory);
+    executor->setRandomSeed(1);
+    executor->configChange(config);
+
+    executor->setScript(loader.parse(RGB_MIXED_SCRIPT));
+    result.assertFalse(executor->isRGBDirect(),"mixed script drawn to HSL frame");
+    executor->step();
+    const uint8_t* pixels = factory.getOutput()->getPixels();
+    result.assertTrue(pixels[2] > 0 && pixels[0] == 0,"hsl element drawn");
+    result.assertTrue(pixels[10*3] > 0 && pixels[10*3+2] == 0,"rgb element drawn");
+
+    executor->setScript(loader.parse(RGB_REPLACE_SCRIPT));
+    result.assertTrue(executor->isRGBDirect(),"rgb script drawn to RGB strip");
+    delete executor;
+    Config::setInstance(appConfig);
+}
+
+// commands are sent even if the LEDs already show the same frame
+void ScriptTestSuite::executorResend(TestResult& result) {
+    MemoryOutputFactory factory;
+    Config config;
+    config.addPin(1,EXECUTOR_TEST_LEDS);
+    Config* appConfig = Config::getInstance();
+    Config::setInstance(&config);
+    ScriptExecutor* executor = new ScriptExecutor();
+    executor->setOutputFactory(&factory);
+    executor->configChange(config);
+    MemoryLedOutput* output = factory.getOutput();
+    int shown = output->getShown();
+    executor->turnOff();
+    executor->turnOff();
+    result.assertEqual(output->getShown(),shown+2,"turnOff always sent");
+    result.assertEqual((int)executor->getSkippedFrames(),0,"turnOff not skipped");
+    delete executor;
+    Config::setInstance(appConfig);
+}
+
+// a pin without a strip must not shift the brightness of the pins after it
+void ScriptTestSuite::executorSkippedStrip(TestResult& result) {
+    ScriptDataLoader loader;
+    MemoryOutputFactory factory(2);
+    Config config;
+    config.addPin(1,EXECUTOR_TEST_LEDS)->maxBrightness = 40;
+    config.addPin(2,EXECUTOR_TEST_LEDS)->maxBrightness = 5;
+    config.addPin(3,EXECUTOR_TEST_LEDS)->maxBrightness = 40;
+    Config* appConfig = Config::getInstance();
+    Config::setInstance(&config);
+    ScriptExecutor* executor = new ScriptExecutor();
+    executor->setOutputFactory(&factory);
+    executor->configChange(config);
+    executor->setScript(loader.parse(HSL_SIMPLE_SCRIPT));
+    executor->step();
+    const uint8_t* first = factory.getOutput(1)->getPixels();
+    const uint8_t* last = factory.getOutput(3)->getPixels();
+    result.assertTrue(first[0] > 0,"first strip drawn");
+    result.assertTrue(memcmp(first,last,EXECUTOR_TEST_LEDS*3) == 0,"last strip has its own brightness");
+    delete executor;
+    Config::setInstance(appConfig);
+}
+
 }
 #endif 
 
@@ -0,0 +1,516 @@
+#ifndef SCRIPT_VALUE_TEST_SUITE_H
+#define SCRIPT_VALUE_TEST_SUITE_H
+
+
+#include "../lib/test/test_suite.h"
+#include "../lib/json/parser.h"
+#include "../script/script_value.h"
+#include "../script/script_context.h"
+
+#if RUN_TESTS==1
+namespace DevRelief {
+
+const char *FUNCTION_VALUES = R"script(
+        {
+            "add": ["+",10,20],
+            "subtract": ["sub",10,4],
+            "negate": ["-",7],
+            "multiply": ["mult",3,["*",2,5]],
+            "divide": ["/",9,3],
+            "divideZero": ["divide",9,0],
+            "mod": ["%",17,5],
+            "modZero": ["%",17,0],
+            "modFraction": ["%",17,0.5],
+            "min": ["min",3,8],
+            "max": ["max",3,8],
+            "led": ["+",10,["*","sys(led)",2]],
+            "step": ["%","sys(step)",50],
+            "random": ["+",1,["rand",0,10]],
+            "randomOf": ["randOf",3,5,7],
+            "variable": ["+",1,"var(x)"],
+            "missingArg": ["+",5],
+            "sin": ["sin",25,100,0,100],
+            "cos": ["cos",50,100,0,100],
+            "triangle": ["triangle",10,40,0,100],
+            "saw": ["saw",30,40,0,100],
+            "noise": ["noise","sys(led)",10,0,100],
+            "ledTriangle": ["triangle","sys(led)",40,0,100],
+            "nestedTriangle": ["*",100,["-",1,["max",["-",["*",2,["/",["%","sys(led)",40],40]],1],
+                                                  ["-",1,["*",2,["/",["%","sys(led)",40],40]]]]]]
+        }
+    )script";
+
+const char *LARGE_PATTERNS = R"script(
+        {
+            "step": {"pattern": [0,10,20,30,40,50,60,70,80,90,100,110,120,130,140,150,160,170,180,190,
+                                 200,210,220,230,240,250,260,270,280,290,300,310,320,330,340,350,0,10,20,30,
+                                 40,50,60,70,80,90,100,110,120,130]},
+            "smooth": {"pattern": [0,10,20,30,40,50,60,70,80,90,100,110,120,130,140,150,160,170,180,190,
+                                   200,210,220,230,240,250,260,270,280,290,300,310,320,330,340,350,0,10,20,30,
+                                   40,50,60,70,80,90,100,110,120,130], "smooth": true},
+            "unfold": {"pattern": [0,100,50,"200x10%"], "smooth": true, "repeat": false, "unfold": true},
+            "led": {"pattern": [0,["+",10,"sys(led)"],50], "smooth": true}
+        }
+    )script";
+
+// number of pattern elements in the segment search test
+#define PATTERN_TEST_ELEMENTS 50
+
+// exposes the segment search
+class TestStepInterpolation : public StepInterpolation {
+    public:
+        void setup(ScriptPatternElement** elements, int count) { setupSegments(elements,count,count);}
+        InterpolationSegment* find(double pct) { return findSegment(pct);}
+        // the first segment containing pct, found without the search
+        InterpolationSegment* scan(double pct) {
+            for(int i=0;i<m_segmentCount;i++) {
+                if (segmentContains(i,pct)) { return &m_segments[i];}
+            }
+            return NULL;
+        }
+};
+
+// number of LEDs*frames evaluated by the benchmark.  matches a 600 LED strip for 10 frames
+#define SCRIPT_VALUE_BENCHMARK_LEDS 600
+#define SCRIPT_VALUE_BENCHMARK_FRAMES 10
+
+class ScriptValueTestSuite : public TestSuite{
+    public:
+
+        static bool Run(ILogger* logger) {
+            ScriptValueTestSuite test(logger);
+            test.run();
+            return test.isSuccess();
+        }
+
+        void run() {
+            runTest("testFunctionCodes",[&](TestResult&r){testFunctionCodes(r);});
+            runTest("testFunctions",[&](TestResult&r){testFunctions(r);});
+            runTest("testVariance",[&](TestResult&r){testVariance(r);});
+            runTest("testVariableLookup",[&](TestResult&r){testVariableLookup(r);});
+            runTest("testRandom",[&](TestResult&r){testRandom(r);});
+            runTest("testWaves",[&](TestResult&r){testWaves(r);});
+            runTest("testPatternSegments",[&](TestResult&r){testPatternSegments(r);});
+            runTest("testPatternRaster",[&](TestResult&r){testPatternRaster(r);});
+            runTest("benchmarkFunctions",[&](TestResult&r){benchmarkFunctions(r);});
+            runTest("benchmarkPatterns",[&](TestResult&r){benchmarkPatterns(r);});
+            runTest("benchmarkWaves",[&](TestResult&r){benchmarkWaves(r);});
+        }
+
+        ScriptValueTestSuite(ILogger* logger) : TestSuite("ScriptValue Tests",logger){
+
+        }
+
+    protected:
+        void testFunctionCodes(TestResult& result);
+        void testFunctions(TestResult& result);
+        void testVariance(TestResult& result);
+        void testVariableLookup(TestResult& result);
+        void testRandom(TestResult& result);
+        void testWaves(TestResult& result);
+        void testPatternSegments(TestResult& result);
+        void testPatternRaster(TestResult& result);
+        bool isRasterSame(JsonObject* values, const char * name);
+        void benchmarkFunctions(TestResult& result);
+        void benchmarkPatterns(TestResult& result);
+        double benchmarkPattern(JsonObject* values, const char * name);
+        void benchmarkWaves(TestResult& result);
+        double benchmarkLEDs(IScriptValue* value, RootContext& ctx, unsigned long& usecs);
+
+        int variance(JsonObject* values, const char * name) {
+            IScriptValue* value = ScriptValue::create(values->getPropertyValue(name));
+            if (value == NULL) { return -1;}
+            int result = value->getVariance();
+            value->destroy();
+            return result;
+        }
+
+        double evaluate(JsonObject* values, const char * name, IScriptContext* ctx) {
+            IScriptValue* value = ScriptValue::create(values->getPropertyValue(name));
+            if (value == NULL) { return -1;}
+            double result = value->getFloatValue(ctx,-1);
+            value->destroy();
+            return result;
+        }
+};
+
+void ScriptValueTestSuite::testFunctionCodes(TestResult& result) {
+    result.assertEqual(ScriptFunction::getFunctionCode("+"),FUNC_ADD,"+ is add");
+    result.assertEqual(ScriptFunction::getFunctionCode("sub"),FUNC_SUBTRACT,"sub is subtract");
+    result.assertEqual(ScriptFunction::getFunctionCode("mult"),FUNC_MULTIPLY,"mult is multiply");
+    result.assertEqual(ScriptFunction::getFunctionCode("sequence"),FUNC_SEQUENCE,"sequence");
+    result.assertEqual(ScriptFunction::getFunctionCode("randOf"),FUNC_RANDOM_OF,"randOf");
+    result.assertEqual(ScriptFunction::getFunctionCode("foo"),FUNC_UNKNOWN,"unknown name");
+    result.assertEqual(ScriptFunction::getFunctionCode(NULL),FUNC_UNKNOWN,"NULL name");
+    result.assertFalse(ScriptFunction::isFunctionName(""),"empty name");
+}
+
+void ScriptValueTestSuite::testFunctions(TestResult& result) {
+    JsonParser parser;
+    JsonRoot* root = parser.read(FUNCTION_VALUES);
+    JsonObject* values = root->getTopObject();
+    RootContext ctx;
+    ctx.getAnimationPositionDomain()->setPosition(5,0,10);
+
+    result.assertEqual(evaluate(values,"add",&ctx),30,"add");
+    result.assertEqual(evaluate(values,"subtract",&ctx),6,"subtract");
+    result.assertEqual(evaluate(values,"negate",&ctx),-7,"negate");
+    result.assertEqual(evaluate(values,"multiply",&ctx),30,"multiply");
+    result.assertEqual(evaluate(values,"divide",&ctx),3,"divide");
+    result.assertEqual(evaluate(values,"divideZero",&ctx),0,"divide by 0");
+    result.assertEqual(evaluate(values,"mod",&ctx),2,"mod");
+    result.assertEqual(evaluate(values,"modZero",&ctx),0,"mod by 0");
+    result.assertEqual(evaluate(values,"modFraction",&ctx),0,"mod by a fraction of 1");
+    result.assertEqual(evaluate(values,"min",&ctx),3,"min");
+    result.assertEqual(evaluate(values,"max",&ctx),8,"max");
+    result.assertEqual(evaluate(values,"led",&ctx),20,"sys(led)");
+    result.assertEqual(evaluate(values,"sin",&ctx),100,"sin top");
+    result.assertEqual(evaluate(values,"cos",&ctx),0,"cos bottom");
+    result.assertEqual(evaluate(values,"triangle",&ctx),50,"triangle");
+    result.assertEqual(evaluate(values,"saw",&ctx),75,"saw");
+    result.assertEqual(variance(values,"sin"),VARIANCE_CONSTANT,"constant wave");
+    result.assertEqual(variance(values,"noise"),VARIANCE_LED,"sys(led) noise");
+    root->destroy();
+}
+
+void ScriptValueTestSuite::testVariance(TestResult& result) {
+    JsonParser parser;
+    JsonRoot* root = parser.read(FUNCTION_VALUES);
+    JsonObject* values = root->getTopObject();
+    RootContext ctx;
+
+    result.assertEqual(variance(values,"add"),VARIANCE_CONSTANT,"constant function");
+    result.assertEqual(variance(values,"multiply"),VARIANCE_CONSTANT,"nested constant function");
+    result.assertEqual(variance(values,"step"),VARIANCE_FRAME,"sys(step) function");
+    result.assertEqual(variance(values,"led"),VARIANCE_LED,"sys(led) function");
+    result.assertEqual(variance(values,"random"),VARIANCE_LED,"rand function");
+    result.assertEqual(variance(values,"variable"),VARIANCE_LED,"var() function");
+    // missing args use the caller's default so the function is not folded
+    result.assertEqual(evaluate(values,"missingArg",&ctx),4,"missing arg uses default");
+    root->destroy();
+}
+
+void ScriptValueTestSuite::testVariableLookup(TestResult& result) {
+    ScriptNames names;
+    int id = names.getId("testLookupA");
+    result.assertTrue(id >= 0,"name interned");
+    result.assertEqual(names.getId("testLookupA"),id,"same name same id");
+    result.assertEqual(names.findId("testLookupA"),id,"find interned name");
+    result.assertEqual(names.findId("testLookupNeverUsed"),-1,"name not interned");
+    result.assertTrue(names.getSysId("testLookupA") != id,"sys name is separate");
+    // enough names to grow the hash tables
+    ScriptValueList list(&names);
+    for(int i=0;i<40;i++) {
+        DRFormattedString name("testLookup%d",i);
+        list.setValue(name.text(),new ScriptNumberValue(i));
+    }
+    result.assertEqual(list.count(),40,"list has all values");
+    result.assertEqual(list.getValue("testLookup0")->getIntValue(NULL,-1),0,"first value");
+    result.assertEqual(list.getValue("testLookup39")->getIntValue(NULL,-1),39,"last value");
+    list.setValue("testLookup7",new ScriptNumberValue(70));
+    result.assertEqual(list.count(),40,"replace does not add");
+    result.assertEqual(list.getValue("testLookup7")->getIntValue(NULL,-1),70,"replaced value");
+    result.assertTrue(list.getValue("testLookupA") == NULL,"missing value");
+    result.assertEqual(names.getCount(),42,"names from the list");
+    // lists parsed from a script have no names until they are used in a context
+    ScriptValueList parsed;
+    parsed.setValue("testLookupA",new ScriptNumberValue(1));
+    parsed.setValue("testLookupA",new ScriptNumberValue(2));
+    result.assertEqual(parsed.count(),1,"parsed list replaces by name");
+    result.assertEqual(parsed.getValue("testLookupA")->getIntValue(NULL,-1),2,"parsed list value");
+
+    RootContext root;
+    root.setParams(NULL);
+    root.setValue("testLookupA",new ScriptNumberValue(5));
+    ChildContext child(&root);
+    child.setValue("testLookupB",new ScriptNumberValue(6));
+    result.assertEqual(child.getValue("testLookupA")->getIntValue(NULL,-1),5,"value from parent context");
+    result.assertEqual(child.getValue("testLookupB")->getIntValue(NULL,-1),6,"value from child context");
+    result.assertEqual(child.getSysValue("blue")->getIntValue(NULL,-1),(int)HUE::BLUE,"sys value");
+    ScriptVariableValue var(true,"green",NULL);
+    result.assertEqual(var.getIntValue(&child,-1),(int)HUE::GREEN,"sys() variable");
+    ScriptVariableValue led(true,"led",NULL);
+    child.getAnimationPositionDomain()->setPosition(12,0,20);
+    result.assertEqual(led.getIntValue(&child,-1),12,"sys(led) accessor");
+    result.assertEqual((int)led.getUnitValue(&child,-1,POS_PIXEL).getValue(),12,"sys(led) unit value");
+    result.assertTrue(led.isNumber(&child),"sys(led) is a number");
+
+    // each script run has its own names.  a value finds its id again in a new run's table
+    RootContext other;
+    other.setParams(NULL);
+    result.assertTrue(other.getNames() != root.getNames(),"names belong to the root context");
+    result.assertTrue(child.getNames() == root.getNames(),"child uses root names");
+    result.assertEqual(other.getNames()->findId("testLookupB"),-1,"names from another run not added");
+    other.setValue("testLookupA",new ScriptNumberValue(8));
+    ScriptVariableValue var2(false,"testLookupA",NULL);
+    result.assertEqual(var2.getIntValue(&root,-1),5,"variable in first run");
+    result.assertEqual(var2.getIntValue(&other,-1),8,"variable in second run");
+    result.assertEqual(var2.getIntValue(&child,-1),5,"variable back in first run");
+}
+
+// a script run seeded the same way must get the same values
+void ScriptValueTestSuite::testRandom(TestResult& result) {
+    JsonParser parser;
+    JsonRoot* root = parser.read(FUNCTION_VALUES);
+    IScriptValue* value = ScriptValue::create(root->getTopObject()->getPropertyValue("random"));
+    IScriptValue* valueOf = ScriptValue::create(root->getTopObject()->getPropertyValue("randomOf"));
+    RootContext first;
+    RootContext second;
+    RootContext other;
+    first.getRandom()->setSeed(12);
+    second.getRandom()->setSeed(12);
+    other.getRandom()->setSeed(13);
+    ChildContext child(&second);
+    bool same = true;
+    bool differs = false;
+    bool inRange = true;
+    bool isArg = true;
+    int seen[11] = {0};
+    for(int i=0;i<1000;i++) {
+        int val = value->getIntValue(&first,-1);
+        // values from a child context come from the root's generator
+        if (val != value->getIntValue(&child,-1)) { same = false;}
+        if (val != value->getIntValue(&other,-1)) { differs = true;}
+        if (val < 1 || val > 11) { 
+            inRange = false;
+        } else if (val <= 10) {
+            seen[val]++;
+        }
+    }
+    for(int i=0;i<100;i++) {
+        int of = valueOf->getIntValue(&first,-1);
+        if (of != 3 && of != 5 && of != 7) { isArg = false;}
+    }
+    result.assertTrue(same,"same seed same values");
+    result.assertTrue(differs,"different seed different values");
+    result.assertTrue(inRange,"rand values in range");
+    bool allSeen = true;
+    for(int i=1;i<=10;i++) {
+        if (seen[i] == 0) { allSeen = false;}
+    }
+    result.assertTrue(allSeen,"rand returns every value");
+    result.assertTrue(isArg,"randOf returns an arg");
+    value->destroy();
+    valueOf->destroy();
+    root->destroy();
+}
+
+void ScriptValueTestSuite::testWaves(TestResult& result) {
+    double maxDiff = 0;
+    for(long phase=0;phase<65536;phase+=7) {
+        double diff = fabs(Wave::sine(phase)-(sin(2*M_PI*phase/65536)+1)/2);
+        if (diff > maxDiff) { maxDiff = diff;}
+    }
+    result.assertTrue(maxDiff < 0.0002,"sine table within 0.0002 of sin()");
+    result.assertEqual(Wave::toPhase(-10,40),49152,"negative x wraps");
+    result.assertEqual(Wave::toPhase(5,0),0,"no period");
+    result.assertEqual(Wave::toPhase(-1e-18,1),0,"tiny negative x wraps to 0");
+    result.assertEqual(Wave::toPhase(-10.5,40),(uint16_t)(29.5/40*65536),"fraction uses double math");
+    bool sameAsDouble = true;
+    for(int period=1;period<300;period+=7) {
+        for(int x=-600;x<600;x+=13) {
+            double cycles = (double)x/period;
+            cycles -= floor(cycles);
+            uint16_t expected = (uint16_t)((uint32_t)(cycles*65536) & 0xFFFF);
+            // double math can land just below a whole phase
+            if (abs(Wave::toPhase(x,period)-expected) > 1) {
+                sameAsDouble = false;
+            }
+        }
+    }
+    result.assertTrue(sameAsDouble,"whole numbers match the double phase");
+    bool inRange = true;
+    double maxStep = 0;
+    double prev = Wave::noise(0);
+    for(int i=1;i<10000;i++) {
+        double value = Wave::noise(i/100.0);
+        if (value < 0 || value > 1) { inRange = false;}
+        if (fabs(value-prev) > maxStep) { maxStep = fabs(value-prev);}
+        prev = value;
+    }
+    result.assertTrue(inRange,"noise between 0 and 1");
+    // the steepest part of smoothstep is 1.5x the straight line
+    result.assertTrue(maxStep < 0.02,"noise is smooth");
+    result.assertTrue(Wave::noise(3.5) == Wave::noise(3.5+WAVE_TABLE_SIZE),"noise repeats every table");
+    result.assertTrue(Wave::noise(3.5) == Wave::noise(3.5-WAVE_TABLE_SIZE*3),"negative noise repeats");
+    result.assertTrue(Wave::noise(3.5) == Wave::noise(3.5+WAVE_TABLE_SIZE*65536.0*65536.0),"huge noise repeats");
+    double huge = Wave::noise(1e300);
+    result.assertTrue(huge >= 0 && huge <= 1,"huge noise between 0 and 1");
+    double negative = Wave::noise(-1e300);
+    result.assertTrue(negative >= 0 && negative <= 1,"huge negative noise between 0 and 1");
+    result.assertTrue(Wave::noise(NAN) == 0.5,"NaN noise");
+    result.assertTrue(Wave::noise(INFINITY) == 0.5,"inf noise");
+    result.assertTrue(Wave::noise(-INFINITY) == 0.5,"-inf noise");
+    result.assertEqual(Wave::toPhase(NAN,40),0,"NaN x phase");
+    result.assertEqual(Wave::toPhase(INFINITY,40),0,"inf x phase");
+    result.assertEqual(Wave::toPhase(-INFINITY,40),0,"-inf x phase");
+    result.assertEqual(Wave::toPhase(10,NAN),0,"NaN period phase");
+    result.assertEqual(Wave::toPhase(10,INFINITY),0,"inf period phase");
+}
+
+// searched segments must be the ones a scan finds in any LED order
+void ScriptValueTestSuite::testPatternSegments(TestResult& result) {
+    ScriptPatternElement* elements[PATTERN_TEST_ELEMENTS];
+    for(int i=0;i<PATTERN_TEST_ELEMENTS;i++) {
+        elements[i] = new ScriptPatternElement(NULL,POS_UNSET,NULL);
+        elements[i]->update(NULL);
+    }
+    TestStepInterpolation interpolation;
+    interpolation.setup(elements,PATTERN_TEST_ELEMENTS);
+    bool same = true;
+    for(int i=0;i<=1000;i++) {
+        double pct = i/1000.0;
+        if (interpolation.find(pct) != (pct >= 1 ? interpolation.find(1) : interpolation.scan(pct))) { same = false;}
+    }
+    result.assertTrue(same,"ascending LEDs");
+    for(int i=999;i>0;i-=7) {
+        double pct = i/1000.0;
+        if (interpolation.find(pct) != interpolation.scan(pct)) { same = false;}
+    }
+    result.assertTrue(same,"descending LEDs");
+    result.assertEqual(interpolation.find(0.5)->startElementIndex,25,"middle element");
+    result.assertEqual(interpolation.find(1)->startElementIndex,PATTERN_TEST_ELEMENTS-1,"last element");
+    for(int i=0;i<PATTERN_TEST_ELEMENTS;i++) {
+        elements[i]->destroy();
+    }
+}
+
+// values read from the per-step raster must match values calculated for each LED
+void ScriptValueTestSuite::testPatternRaster(TestResult& result) {
+    JsonParser parser;
+    JsonRoot* root = parser.read(LARGE_PATTERNS);
+    JsonObject* values = root->getTopObject();
+    result.assertTrue(isRasterSame(values,"step"),"step pattern");
+    result.assertTrue(isRasterSame(values,"smooth"),"smooth pattern");
+    result.assertTrue(isRasterSame(values,"unfold"),"unfold pattern");
+    result.assertTrue(isRasterSame(values,"led"),"pattern with per-LED value");
+    root->destroy();
+}
+
+bool ScriptValueTestSuite::isRasterSame(JsonObject* values, const char * name) {
+    IScriptValue* raster = ScriptValue::create(values->getPropertyValue(name));
+    IScriptValue* calculated = ScriptValue::create(values->getPropertyValue(name));
+    RootContext rasterCtx;
+    // every LED is a new step so the value is calculated for the LED
+    RootContext calculatedCtx;
+    bool same = true;
+    for(int frame=0;frame<3;frame++) {
+        int length = 100+frame*20;
+        rasterCtx.beginStep();
+        for(int led=0;led<length;led++) {
+            rasterCtx.getAnimationPositionDomain()->setPosition(led,0,length-1);
+            calculatedCtx.getAnimationPositionDomain()->setPosition(led,0,length-1);
+            calculatedCtx.beginStep();
+            double expected = calculated->getFloatValue(&calculatedCtx,-1);
+            calculatedCtx.endStep();
+            double value = raster->getFloatValue(&rasterCtx,-1);
+            if (value != expected) {
+                m_logger->error("%s pattern LED %d: %f != %f",name,led,value,expected);
+                same = false;
+            }
+        }
+        rasterCtx.endStep();
+    }
+    raster->destroy();
+    calculated->destroy();
+    return same;
+}
+
+void ScriptValueTestSuite::benchmarkFunctions(TestResult& result) {
+    JsonParser parser;
+    JsonRoot* root = parser.read(FUNCTION_VALUES);
+    IScriptValue* value = ScriptValue::create(root->getTopObject()->getPropertyValue("led"));
+    RootContext ctx;
+    ctx.beginStep();
+    PositionDomain* domain = ctx.getAnimationPositionDomain();
+    double total = 0;
+    unsigned long start = micros();
+    for(int frame=0;frame<SCRIPT_VALUE_BENCHMARK_FRAMES;frame++) {
+        for(int led=0;led<SCRIPT_VALUE_BENCHMARK_LEDS;led++) {
+            domain->setPosition(led,0,SCRIPT_VALUE_BENCHMARK_LEDS);
+            total += value->getFloatValue(&ctx,0);
+        }
+    }
+    unsigned long usecs = micros()-start;
+    int count = SCRIPT_VALUE_BENCHMARK_FRAMES*SCRIPT_VALUE_BENCHMARK_LEDS;
+    m_logger->info("benchmark: %d evaluations in %d usecs.  %d nsecs per LED",count,(int)usecs,(int)(usecs*1000/count));
+    result.assertTrue(total > 0,"benchmark evaluated values");
+    value->destroy();
+    root->destroy();
+}
+
+void ScriptValueTestSuite::benchmarkPatterns(TestResult& result) {
+    JsonParser parser;
+    JsonRoot* root = parser.read(LARGE_PATTERNS);
+    double total = benchmarkPattern(root->getTopObject(),"step");
+    total += benchmarkPattern(root->getTopObject(),"smooth");
+    result.assertTrue(total > 0,"benchmark evaluated patterns");
+    root->destroy();
+}
+
+// a wave function against the nested arithmetic designers use for the same wave
+void ScriptValueTestSuite::benchmarkWaves(TestResult& result) {
+    JsonParser parser;
+    JsonRoot* root = parser.read(FUNCTION_VALUES);
+    IScriptValue* wave = ScriptValue::create(root->getTopObject()->getPropertyValue("ledTriangle"));
+    IScriptValue* nested = ScriptValue::create(root->getTopObject()->getPropertyValue("nestedTriangle"));
+    RootContext ctx;
+    PositionDomain* domain = ctx.getAnimationPositionDomain();
+    bool same = true;
+    for(int led=0;led<100;led++) {
+        domain->setPosition(led,0,SCRIPT_VALUE_BENCHMARK_LEDS);
+        if (fabs(wave->getFloatValue(&ctx,0)-nested->getFloatValue(&ctx,0)) > 0.01) { same = false;}
+    }
+    result.assertTrue(same,"triangle matches nested arithmetic");
+    unsigned long waveUsecs = 0;
+    unsigned long nestedUsecs = 0;
+    double total = benchmarkLEDs(wave,ctx,waveUsecs);
+    total += benchmarkLEDs(nested,ctx,nestedUsecs);
+    int count = SCRIPT_VALUE_BENCHMARK_FRAMES*SCRIPT_VALUE_BENCHMARK_LEDS;
+    m_logger->info("benchmark: %d triangles. function %d usecs.  nested arithmetic %d usecs",count,(int)waveUsecs,(int)nestedUsecs);
+    result.assertTrue(total > 0,"benchmark evaluated waves");
+    wave->destroy();
+    nested->destroy();
+    root->destroy();
+}
+
+double ScriptValueTestSuite::benchmarkLEDs(IScriptValue* value, RootContext& ctx, unsigned long& usecs) {
+    PositionDomain* domain = ctx.getAnimationPositionDomain();
+    double total = 0;
+    unsigned long start = micros();
+    for(int frame=0;frame<SCRIPT_VALUE_BENCHMARK_FRAMES;frame++) {
+        for(int led=0;led<SCRIPT_VALUE_BENCHMARK_LEDS;led++) {
+            domain->setPosition(led,0,SCRIPT_VALUE_BENCHMARK_LEDS);
+            total += value->getFloatValue(&ctx,0);
+        }
+    }
+    usecs = micros()-start;
+    return total;
+}
+
+double ScriptValueTestSuite::benchmarkPattern(JsonObject* values, const char * name) {
+    IScriptValue* value = ScriptValue::create(values->getPropertyValue(name));
+    if (value == NULL) { return 0;}
+    RootContext ctx;
+    PositionDomain* domain = ctx.getAnimationPositionDomain();
+    double total = 0;
+    unsigned long start = micros();
+    for(int frame=0;frame<SCRIPT_VALUE_BENCHMARK_FRAMES;frame++) {
+        ctx.beginStep();
+        for(int led=0;led<SCRIPT_VALUE_BENCHMARK_LEDS;led++) {
+            domain->setPosition(led,0,SCRIPT_VALUE_BENCHMARK_LEDS);
+            total += value->getFloatValue(&ctx,0);
+        }
+        ctx.endStep();
+    }
+    unsigned long usecs = micros()-start;
+    int count = SCRIPT_VALUE_BENCHMARK_FRAMES*SCRIPT_VALUE_BENCHMARK_LEDS;
+    m_logger->info("benchmark: %s pattern %d evaluations in %d usecs.  %d nsecs per LED",name,count,(int)usecs,(int)(usecs*1000/count));
+    value->destroy();
+    return total;
+}
+
+}
+#endif
+
+#endif
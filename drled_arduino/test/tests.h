@@ -7,11 +7,16 @@
 #include "../lib/log/config.h"
 #include "./json_suite.h"
 #include "./string_suite.h"
+#include "./animation_suite.h"
 #include "./api_suite.h"
 #include "./script_loader_suite.h"
 #include "./script_suite.h"
+#include "./script_value_suite.h"
 #include "./app_state_suite.h"
 #include "./timer_suite.h"
+#include "./color_suite.h"
+#include "./hsl_strip_suite.h"
+#include "./frame_scheduler_suite.h"
 #endif 
 
 namespace DevRelief {
@@ -69,6 +74,9 @@ namespace DevRelief {
             #if RUN_SCRIPT_TESTS==1
             success = ScriptTestSuite::Run(m_logger) && success;
             #endif
+            #if RUN_SCRIPT_VALUE_TESTS==1
+            success = ScriptValueTestSuite::Run(m_logger) && success;
+            #endif
             #if RUN_APP_STATE_TESTS==1
             success = AppStateTestSuite::Run(m_logger) && success;
             #endif
@@ -76,6 +84,15 @@ namespace DevRelief {
             #if RUN_TIMER_TESTS==1
             success = TimerTestSuite::Run(m_logger) && success;
             #endif
+            #if RUN_COLOR_TESTS==1
+            success = ColorTestSuite::Run(m_logger) && success;
+            #endif
+            #if RUN_HSL_STRIP_TESTS==1
+            success = HSLStripTestSuite::Run(m_logger) && success;
+            #endif
+            #if RUN_FRAME_SCHEDULER_TESTS==1
+            success = FrameSchedulerTestSuite::Run(m_logger) && success;
+            #endif
             //success = runTest("testSharedPtr",&Tests::testSharedPtr) && success;
             //success = runTest("testStringBuffer",&Tests::testStringBuffer) && success;
             //success = runTest("testDRString",&Tests::testDRString) && success;
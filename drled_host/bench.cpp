@@ -0,0 +1,240 @@
+// host render benchmark.  runs a script through ScriptExecutor on simulated strips.
+//
+//   bench [options] script.json...
+//      -f frames   frames to run (default 500)
+//      -l leds     LEDs per strip (default 300)
+//      -s strips   number of strips (default 2).  odd strips are reversed
+//      -r fps      simulated clock rate.  millis() advances 1000/fps per step (default 20)
+//      -q          only print one summary line per script
+//      -h          always draw through the HSL frame, even for RGB only scripts
+//      -w file     append every frame sent to the simulated wire to file
+//
+// reports frames/second, parse/draw/show time, modeled WS2812 transmit time,
+// heap allocations per frame and a hash of the final pixels so output changes can be detected.
+
+#include <chrono>
+#include <new>
+#include "env.h"
+#include "lib/log/logger.h"
+#include "loggers.h"
+#include "script/data_loader.h"
+#include "script/executor.h"
+#include "wire_output.h"
+
+using namespace DevRelief;
+
+unsigned long hostMillis = 1000;
+
+// allocation counters.  malloc family calls from the sources are wrapped by the linker (see Makefile)
+static unsigned long allocationCount = 0;
+static unsigned long allocationBytes = 0;
+
+extern "C" {
+    void* __real_malloc(size_t size);
+    void* __real_calloc(size_t count, size_t size);
+    void* __real_realloc(void* ptr, size_t size);
+    void __real_free(void* ptr);
+
+    void* __wrap_malloc(size_t size) {
+        allocationCount++;
+        allocationBytes += size;
+        return __real_malloc(size);
+    }
+
+    void* __wrap_calloc(size_t count, size_t size) {
+        allocationCount++;
+        allocationBytes += count*size;
+        return __real_calloc(count,size);
+    }
+
+    void* __wrap_realloc(void* ptr, size_t size) {
+        allocationCount++;
+        allocationBytes += size;
+        return __real_realloc(ptr,size);
+    }
+
+    void __wrap_free(void* ptr) {
+        __real_free(ptr);
+    }
+}
+
+void* operator new(size_t size) {
+    allocationCount++;
+    allocationBytes += size;
+    void* block = __real_malloc(size > 0 ? size : 1);
+    if (block == NULL) { throw std::bad_alloc();}
+    return block;
+}
+
+void* operator new[](size_t size) { return operator new(size);}
+// __real_free() so the compiler does not pair operator new with free() (-Wmismatched-new-delete)
+void operator delete(void* ptr) noexcept { __real_free(ptr);}
+void operator delete[](void* ptr) noexcept { operator delete(ptr);}
+// the size is not needed to free a block
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr);}
+void operator delete[](void* ptr, size_t) noexcept { operator delete(ptr);}
+
+static double elapsedUsecs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double,std::micro>(std::chrono::steady_clock::now()-start).count();
+}
+
+static char* readFile(const char* path) {
+    FILE* file = fopen(path,"rb");
+    if (file == NULL) { return NULL;}
+    fseek(file,0,SEEK_END);
+    long size = ftell(file);
+    fseek(file,0,SEEK_SET);
+    char* text = (char*)__real_malloc(size+1);
+    size_t read = fread(text,1,size,file);
+    text[read] = 0;
+    fclose(file);
+    return text;
+}
+
+static uint64_t hashPixels() {
+    uint64_t hash = 1469598103934665603ULL;
+    for(int s=0;s<Adafruit_NeoPixel::getStripCount();s++) {
+        Adafruit_NeoPixel* strip = Adafruit_NeoPixel::getStrip(s);
+        const uint8_t* pixels = strip->getPixels();
+        for(int i=0;i<strip->numPixels()*3;i++) {
+            hash = (hash ^ pixels[i]) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+static int usage() {
+    fprintf(stderr,"usage: bench [-f frames] [-l leds] [-s strips] [-r fps] [-q] [-h] [-w file] script.json...\n");
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    int frames = 500;
+    int leds = 300;
+    int strips = 2;
+    int fps = 20;
+    bool quiet = false;
+    bool hslOnly = false;
+    const char* recordPath = NULL;
+    int arg = 1;
+    while(arg < argc && argv[arg][0] == '-') {
+        const char* flag = argv[arg++];
+        if (strcmp(flag,"-q") == 0) {
+            quiet = true;
+            continue;
+        }
+        if (strcmp(flag,"-h") == 0) {
+            hslOnly = true;
+            continue;
+        }
+        if (arg >= argc) { return usage();}
+        if (strcmp(flag,"-w") == 0) {
+            recordPath = argv[arg++];
+            continue;
+        }
+        int value = atoi(argv[arg++]);
+        if (strcmp(flag,"-f") == 0) { frames = value;}
+        else if (strcmp(flag,"-l") == 0) { leds = value;}
+        else if (strcmp(flag,"-s") == 0) { strips = value;}
+        else if (strcmp(flag,"-r") == 0) { fps = value;}
+        else { return usage();}
+    }
+    if (arg >= argc || frames <= 0 || leds <= 0 || strips <= 0 || fps <= 0) {
+        return usage();
+    }
+
+    // the constructor makes this the config every logger uses
+    NullLogConfig logConfig;
+    Config config;
+    Config::setInstance(&config);
+    for(int s=0;s<strips;s++) {
+        config.addPin(s+1,leds,(s%2)==1);
+    }
+    WireOutputFactory wire;
+    FILE* record = NULL;
+    if (recordPath) {
+        record = fopen(recordPath,"wb");
+        if (record == NULL) {
+            fprintf(stderr,"cannot write %s\n",recordPath);
+            return 1;
+        }
+        wire.setRecord(record);
+    }
+    ScriptExecutor executor;
+    executor.setOutputFactory(&wire);
+    executor.configChange(config);
+    executor.setRGBDirect(!hslOnly);
+    // every run draws the same frames
+    executor.setRandomSeed(1);
+    unsigned long stepMsecs = 1000/fps > 0 ? 1000/fps : 1;
+
+    int result = 0;
+    for(;arg<argc;arg++) {
+        const char* path = argv[arg];
+        char* text = readFile(path);
+        if (text == NULL) {
+            fprintf(stderr,"cannot read %s\n",path);
+            result = 1;
+            continue;
+        }
+        hostMillis = 1000;
+
+        auto parseStart = std::chrono::steady_clock::now();
+        ScriptDataLoader loader;
+        Script* script = loader.parse(text);
+        double parseUsecs = elapsedUsecs(parseStart);
+        free(text);
+        if (script == NULL) {
+            fprintf(stderr,"cannot parse %s\n",path);
+            result = 1;
+            continue;
+        }
+        executor.setScript(script,NULL);
+
+        double drawUsecs = 0;
+        double showUsecs = 0;
+        double transmitUsecs = 0;
+        unsigned long sentBefore = executor.getSentFrames();
+        unsigned long skippedBefore = executor.getSkippedFrames();
+        unsigned long allocationsBefore = allocationCount;
+        unsigned long bytesBefore = allocationBytes;
+        auto runStart = std::chrono::steady_clock::now();
+        for(int i=0;i<frames;i++) {
+            hostMillis += stepMsecs;
+            unsigned long drawn = executor.getFrameStats().getFrames();
+            executor.step();
+            if (executor.getFrameStats().getFrames() != drawn) {
+                drawUsecs += script->getDrawUsecs();
+                showUsecs += script->getShowUsecs();
+                transmitUsecs += executor.getTransmitUsecs();
+            }
+        }
+        double runUsecs = elapsedUsecs(runStart);
+        const FrameStats& stats = executor.getFrameStats();
+        unsigned long drawnFrames = stats.getFrames() > 0 ? stats.getFrames() : 1;
+        double allocations = (double)(allocationCount-allocationsBefore)/drawnFrames;
+        double bytes = (double)(allocationBytes-bytesBefore)/drawnFrames;
+        uint64_t hash = hashPixels();
+
+        const char* mode = executor.isRGBDirect() ? "rgb" : "hsl";
+        if (quiet) {
+            printf("%s hash=%016llx %.1f us/frame %.1f allocs/frame %s\n",script->getName(),
+                (unsigned long long)hash,runUsecs/drawnFrames,allocations,mode);
+        } else {
+            printf("%s (%s) %d strips x %d LEDs %s\n",script->getName(),path,strips,leds,mode);
+            printf("  frames     %lu drawn of %d steps.  %lu late, %lu dropped\n",stats.getFrames(),frames,stats.getLateFrames(),stats.getDroppedFrames());
+            printf("  speed      %.0f frames/second  %.1f us/frame\n",drawnFrames*1e6/runUsecs,runUsecs/drawnFrames);
+            printf("  parse      %.1f us\n",parseUsecs);
+            printf("  draw       %.1f us/frame\n",drawUsecs/drawnFrames);
+            printf("  show       %.1f us/frame\n",showUsecs/drawnFrames);
+            printf("  transmit   %.1f us/frame on the wire\n",transmitUsecs/drawnFrames);
+            printf("  strips     %lu frames sent, %lu unchanged frames skipped\n",executor.getSentFrames()-sentBefore,executor.getSkippedFrames()-skippedBefore);
+            printf("  frame      min %lu  avg %lu  p99 %lu  max %lu us\n",stats.getMinUsecs(),stats.getAverageUsecs(),stats.getP99Usecs(),stats.getMaxUsecs());
+            printf("  heap       %.1f allocations/frame  %.0f bytes/frame\n",allocations,bytes);
+            printf("  output     hash=%016llx\n",(unsigned long long)hash);
+        }
+        executor.endScript();
+    }
+    if (record) { fclose(record);}
+    return result;
+}
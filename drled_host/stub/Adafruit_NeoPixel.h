@@ -0,0 +1,103 @@
+#ifndef HOST_ADAFRUIT_NEOPIXEL_H
+#define HOST_ADAFRUIT_NEOPIXEL_H
+// host stand-in for the Adafruit NeoPixel library.  pixels are kept in memory.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint16_t neoPixelType;
+#define NEO_GRB 0x52
+#define NEO_RGB 0x06
+#define NEO_KHZ800 0x0000
+
+#define HOST_MAX_NEOPIXEL_STRIPS 8
+
+class Adafruit_NeoPixel {
+    public:
+        Adafruit_NeoPixel(uint16_t count, int16_t pin, neoPixelType) {
+            m_count = count;
+            m_pin = pin;
+            m_pixels = (uint8_t*)calloc(count*3,1);
+            m_brightness = 0;
+            if (s_stripCount < HOST_MAX_NEOPIXEL_STRIPS) {
+                s_strips[s_stripCount++] = this;
+            }
+        }
+
+        ~Adafruit_NeoPixel() {
+            for(int i=0;i<s_stripCount;i++) {
+                if (s_strips[i] == this) {
+                    s_strips[i] = s_strips[--s_stripCount];
+                    break;
+                }
+            }
+            free(m_pixels);
+        }
+
+        void begin() {}
+        void show() {}
+        void clear() { memset(m_pixels,0,m_count*3);}
+        // scales pixels like the Adafruit library.  m_brightness is brightness+1 so 0 is full brightness
+        void setBrightness(uint8_t brightness) {
+            uint8_t newBrightness = brightness+1;
+            if (newBrightness == m_brightness) { return;}
+            uint8_t oldBrightness = m_brightness-1;
+            uint16_t scale;
+            if (oldBrightness == 0) {
+                scale = 0;
+            } else if (brightness == 255) {
+                scale = 65535/oldBrightness;
+            } else {
+                scale = (((uint16_t)newBrightness << 8)-1)/oldBrightness;
+            }
+            for(int i=0;i<m_count*3;i++) {
+                m_pixels[i] = (m_pixels[i]*scale) >> 8;
+            }
+            m_brightness = newBrightness;
+        }
+        uint8_t getBrightness() const { return m_brightness-1;}
+        uint16_t numPixels() const { return m_count;}
+        int16_t getPin() const { return m_pin;}
+        uint8_t* getPixels() const { return m_pixels;}
+
+        static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) { return ((uint32_t)r<<16)|((uint32_t)g<<8)|b;}
+
+        void setPixelColor(uint16_t n, uint32_t color) {
+            if (n < m_count) {
+                uint8_t r = color>>16;
+                uint8_t g = color>>8;
+                uint8_t b = color;
+                if (m_brightness) {
+                    r = (r*m_brightness) >> 8;
+                    g = (g*m_brightness) >> 8;
+                    b = (b*m_brightness) >> 8;
+                }
+                m_pixels[n*3] = r;
+                m_pixels[n*3+1] = g;
+                m_pixels[n*3+2] = b;
+            }
+        }
+        void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) { setPixelColor(n,Color(r,g,b));}
+        uint32_t getPixelColor(uint16_t n) const {
+            return n < m_count ? ((uint32_t)m_pixels[n*3]<<16)|((uint32_t)m_pixels[n*3+1]<<8)|m_pixels[n*3+2] : 0;
+        }
+
+        // every strip that exists.  used by the benchmark to hash the output
+        static int getStripCount() { return s_stripCount;}
+        static Adafruit_NeoPixel* getStrip(int index) { return s_strips[index];}
+
+    private:
+        uint16_t m_count;
+        int16_t m_pin;
+        uint8_t* m_pixels;
+        uint8_t m_brightness;
+
+        static Adafruit_NeoPixel* s_strips[HOST_MAX_NEOPIXEL_STRIPS];
+        static int s_stripCount;
+};
+
+inline Adafruit_NeoPixel* Adafruit_NeoPixel::s_strips[HOST_MAX_NEOPIXEL_STRIPS];
+inline int Adafruit_NeoPixel::s_stripCount = 0;
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+// host stand-in for LittleFS.  paths are relative to LittleFS.root on the host file system.
+
+#include <stdio.h>
+#include <string>
+
+enum SeekMode { SeekSet=0, SeekCur=1, SeekEnd=2 };
+
+class File {
+    public:
+        File(FILE* file=NULL) { m_file = file;}
+        bool isFile() const { return m_file != NULL;}
+        operator bool() const { return m_file != NULL;}
+        size_t size() {
+            if (m_file == NULL) { return 0;}
+            long pos = ftell(m_file);
+            fseek(m_file,0,SEEK_END);
+            long size = ftell(m_file);
+            fseek(m_file,pos,SEEK_SET);
+            return size;
+        }
+        bool seek(size_t pos, SeekMode mode) { return m_file && fseek(m_file,pos,mode) == 0;}
+        size_t read(void* data, size_t length) { return m_file ? fread(data,1,length,m_file) : 0;}
+        size_t write(const void* data, size_t length) { return m_file ? fwrite(data,1,length,m_file) : 0;}
+        void close() {
+            if (m_file) {
+                fclose(m_file);
+                m_file = NULL;
+            }
+        }
+    private:
+        FILE* m_file;
+};
+
+struct HostFileName {
+    std::string name;
+    const char* c_str() const { return name.c_str();}
+};
+
+// directory listing is not needed by the benchmark
+class Dir {
+    public:
+        bool next() { return false;}
+        HostFileName fileName() { return HostFileName();}
+};
+
+class HostFS {
+    public:
+        std::string root = ".";
+        bool begin() { return true;}
+        bool exists(const char* path) {
+            FILE* file = fopen(fullPath(path).c_str(),"r");
+            if (file) {
+                fclose(file);
+                return true;
+            }
+            return false;
+        }
+        bool remove(const char* path) { return ::remove(fullPath(path).c_str()) == 0;}
+        File open(const char* path, const char* mode) { return File(fopen(fullPath(path).c_str(),mode[0]=='w' ? "wb" : "rb"));}
+        Dir openDir(const char*) { return Dir();}
+    private:
+        std::string fullPath(const char* path) { return root+path;}
+};
+
+static HostFS LittleFS;
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef HOST_FAKE_ARDUINO_H
+#define HOST_FAKE_ARDUINO_H
+// the parts of the Arduino/ESP8266 core used by the render pipeline.
+// this is force-included before every source file (see ../Makefile).
+// millis() is a simulated clock the benchmark advances.  micros() is real time.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <algorithm>
+
+typedef unsigned long ulong;
+typedef uint8_t byte;
+using std::min;
+using std::max;
+
+extern unsigned long hostMillis;
+inline unsigned long millis() { return hostMillis;}
+inline unsigned long micros() {
+    static auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-start).count();
+}
+inline long random(long high) { return high <= 0 ? 0 : rand()%high;}
+inline long random(long low, long high) { return high <= low ? low : low+rand()%(high-low);}
+inline void delay(unsigned long) {}
+inline void yield() {}
+
+struct HostSerial {
+    void begin(int) {}
+    void println(const char* text) { puts(text);}
+    void flush() {}
+    operator bool() { return true;}
+    template<class... Args> void printf(const char* format, Args... args) { ::printf(format,args...);}
+};
+inline HostSerial Serial;
+
+struct HostESP {
+    long getFreeHeap() { return 40000;}
+    long getFreeContStack() { return 4096;}
+    long getMaxFreeBlockSize() { return 40000;}
+    long getHeapFragmentation() { return 0;}
+    void restart() {}
+};
+inline HostESP ESP;
+
+class Print {
+    public:
+        virtual size_t write(uint8_t c)=0;
+        size_t print(const char* text) {
+            size_t count = 0;
+            while(text && *text) {
+                write(*text++);
+                count++;
+            }
+            return count;
+        }
+};
+
+class Printable {
+    public:
+        virtual size_t printTo(Print& p) const = 0;
+};
+
+#endif
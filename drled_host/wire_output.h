@@ -0,0 +1,81 @@
+#ifndef HOST_WIRE_OUTPUT_H
+#define HOST_WIRE_OUTPUT_H
+// host LED output that models a WS2812 data line.
+// pixels are kept in a stub Adafruit_NeoPixel so the benchmark can hash them.
+// show() takes no time on the host.  it reports how long the frame would take on the wire
+// and can append each sent frame to a file.
+
+#include <stdio.h>
+#include "lib/led/led_output.h"
+
+using namespace DevRelief;
+
+// 800kHz, 24 bits per LED
+#define WIRE_LED_USECS 30
+// low time that latches the frame
+#define WIRE_RESET_USECS 50
+
+class WireOutput : public ILedOutput {
+    public:
+        WireOutput(int pin, uint16_t ledCount, neoPixelType pixelType, FILE* record) {
+            m_pixels = new Adafruit_NeoPixel(ledCount,pin,pixelType+NEO_KHZ800);
+            m_pixels->setBrightness(255);
+            m_record = record;
+            m_transmitUsecs = 0;
+            m_frames = 0;
+        }
+
+        ~WireOutput() {
+            delete m_pixels;
+        }
+
+        uint16_t numPixels() override { return m_pixels->numPixels();}
+        int getPin() override { return m_pixels->getPin();}
+        void clear() override { m_pixels->clear();}
+
+        void setPixel(uint16_t index, uint8_t red, uint8_t green, uint8_t blue) override {
+            m_pixels->setPixelColor(index,red,green,blue);
+        }
+
+        const uint8_t* getPixels() override { return m_pixels->getPixels();}
+        uint16_t getPixelBytes() override { return numPixels()*3;}
+
+        void show() override {
+            m_transmitUsecs = (unsigned long)numPixels()*WIRE_LED_USECS+WIRE_RESET_USECS;
+            m_frames++;
+            if (m_record) {
+                // pin, LED count, then RGB for each LED
+                int16_t pin = getPin();
+                uint16_t count = numPixels();
+                fwrite(&pin,sizeof(pin),1,m_record);
+                fwrite(&count,sizeof(count),1,m_record);
+                fwrite(m_pixels->getPixels(),3,count,m_record);
+            }
+        }
+
+        unsigned long getTransmitUsecs() override { return m_transmitUsecs;}
+        unsigned long getFrames() const { return m_frames;}
+
+    private:
+        Adafruit_NeoPixel* m_pixels;
+        FILE* m_record;
+        unsigned long m_transmitUsecs;
+        unsigned long m_frames;
+};
+
+class WireOutputFactory : public ILedOutputFactory {
+    public:
+        WireOutputFactory() { m_record = NULL;}
+
+        // frames sent by outputs created after this are appended to record
+        void setRecord(FILE* record) { m_record = record;}
+
+        ILedOutput* create(int pin, uint16_t ledCount, neoPixelType pixelType) override {
+            return new WireOutput(pin,ledCount,pixelType,m_record);
+        }
+
+    private:
+        FILE* m_record;
+};
+
+#endif